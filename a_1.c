@@ -4,7 +4,9 @@
 #include <math.h>
 #include <sys/resource.h>
 #include <time.h>
-#define MAX_USERS 2000
+#include "txn_reader.h"
+#include "txn_users.h"
+#define DEFAULT_USERS 2000  // 실행 시 TXN_USERS 로 바꿀 수 있다
 #define NUM_ATMS 1
 
 // ---------- 구조체 정의 ----------
@@ -17,7 +19,7 @@ typedef struct {
 } AccountInfo;
 
 typedef struct {
-    AccountInfo accounts[MAX_USERS + 1];
+    AccountInfo *accounts;   // max_users + 1 칸 (txn_users_table)
     int atm_funds[NUM_ATMS];
 } AccountDB;
 
@@ -29,12 +31,13 @@ typedef struct {
 } UserInfo;
 
 typedef struct {
-    UserInfo users[MAX_USERS + 1];
+    UserInfo *users;   // max_users + 1 칸 (txn_users_table)
     int bank_funds;
 } UserDB;
 
 // ---------- 전역 변수 ----------
 
+size_t max_users;  // 실행 시 정한 사용자 수 (txn_users.h)
 AccountDB acc_db;
 UserDB loan_db;
 
@@ -42,7 +45,13 @@ UserDB loan_db;
 
 void init_account_db() {
     acc_db.atm_funds[0] = 5000000;
-    for (int i = 1; i <= MAX_USERS; i++) {
+    acc_db.accounts = txn_users_table(sizeof(AccountInfo), max_users);
+    if (!acc_db.accounts) {
+        perror("계좌 테이블 할당 실패");
+        exit(1);
+    }
+    txn_users_report("계좌 테이블", max_users, sizeof(AccountInfo));
+    for (size_t i = 1; i <= max_users; i++) {
         acc_db.accounts[i].user = i;
         acc_db.accounts[i].account = i;
         acc_db.accounts[i].password = i;
@@ -52,7 +61,13 @@ void init_account_db() {
 
 void init_user_db() {
     loan_db.bank_funds = 500000;
-    for (int i = 1; i <= MAX_USERS; i++) {
+    loan_db.users = txn_users_table(sizeof(UserInfo), max_users);
+    if (!loan_db.users) {
+        perror("사용자 테이블 할당 실패");
+        exit(1);
+    }
+    txn_users_report("사용자 테이블", max_users, sizeof(UserInfo));
+    for (size_t i = 1; i <= max_users; i++) {
         loan_db.users[i].user = i;
         loan_db.users[i].identifier = i;
         loan_db.users[i].debt = 0;
@@ -128,7 +143,7 @@ void print_cpu_time() {
 // ---------- 기능 처리 함수 ----------
 
 void atm_worker_line(int amount, int user, int account, int password) {
-    if (user < 1 || user > MAX_USERS) {
+    if (!txn_user_valid(user, max_users)) {
         printf("ATM 처리 실패: 잘못된 사용자 번호 %d\n", user);
         return;
     }
@@ -158,7 +173,7 @@ void atm_worker_line(int amount, int user, int account, int password) {
 }
 
 void mobile_app_transfer(int amount, int name, int account, int password, int receiver) {
-    if (name < 1 || name > MAX_USERS || receiver < 1 || receiver > MAX_USERS) {
+    if (!txn_user_valid(name, max_users) || !txn_user_valid(receiver, max_users)) {
         printf("송금 실패: 잘못된 사용자 번호 (송금자 %d, 수신자 %d)\n", name, receiver);
         return;
     }
@@ -188,7 +203,7 @@ void mobile_app_transfer(int amount, int name, int account, int password, int re
 }
 
 void handle_single_loan(int user, int amount, int identifier) {
-    if (user < 1 || user > MAX_USERS) {
+    if (!txn_user_valid(user, max_users)) {
         printf("대출 실패: 잘못된 사용자 번호 %d\n", user);
         return;
     }
@@ -214,9 +229,10 @@ void handle_single_loan(int user, int amount, int identifier) {
 
 int main(int argc, char *argv[]) {
     if (argc != 2) {
-        fprintf(stderr, "사용법: %s <입력파일>\n", argv[0]);
+        fprintf(stderr, "사용법: %s <입력파일|->\n", argv[0]);
         return 1;
     }
+    max_users = txn_users_count(DEFAULT_USERS);
 
     const char *filename = argv[1];
     srand(time(NULL));
@@ -226,30 +242,30 @@ int main(int argc, char *argv[]) {
     struct timespec start_time, end_time;
     clock_gettime(CLOCK_MONOTONIC, &start_time);
 
-    FILE *fp = fopen(filename, "r");
-    if (!fp) {
+    TxnReader rd;
+    if (txn_reader_open(&rd, filename) < 0) {
         perror("파일 열기 실패");
         return 1;
     }
 
-    int type, amount, user, account, password, receiver, identifier;
-    while (fscanf(fp, "%d", &type) == 1) {
-        if (type == 1) {
-            fscanf(fp, "%d %d %d %d", &amount, &user, &account, &password);
-            atm_worker_line(amount, user, account, password);
-        } else if (type == 2) {
-            fscanf(fp, "%d %d %d", &amount, &user, &identifier);
-            handle_single_loan(user, amount, identifier);
-        } else if (type == 3) {
-            fscanf(fp, "%d %d %d %d %d", &amount, &user, &account, &password, &receiver);
-            mobile_app_transfer(amount, user, account, password, receiver);
+    TxnRecord rec;
+    while (txn_reader_next(&rd, &rec)) {
+        if (rec.type == TXN_ATM) {
+            atm_worker_line(rec.amount, rec.user, rec.account, rec.password);
+        } else if (rec.type == TXN_LOAN) {
+            handle_single_loan(rec.user, rec.amount, txn_identifier(&rec));
         } else {
-            char buf[256];
-            fgets(buf, sizeof(buf), fp);
+            mobile_app_transfer(rec.amount, rec.user, rec.account, rec.password, rec.receiver);
         }
     }
+    if (rd.err) {
+        // 읽기 오류: 지금까지의 합계는 잘린 입력의 것이므로 내지 않는다
+        txn_reader_close(&rd);
+        return 1;
+    }
 
-    fclose(fp);
+    txn_reader_report(&rd);
+    txn_reader_close(&rd);
 
     clock_gettime(CLOCK_MONOTONIC, &end_time);
     double wall_sec = (end_time.tv_sec - start_time.tv_sec)
@@ -2,8 +2,10 @@
 #include <stdlib.h>
 #include <math.h>
 #include <sys/resource.h>
+#include "txn_queues.h"
+#include "txn_users.h"
 #include <time.h>
-#define MAX_USERS 1000
+#define DEFAULT_USERS 1000  // 실행 시 TXN_USERS 로 바꿀 수 있다
 
 typedef struct {
     int user;
@@ -13,16 +15,23 @@ typedef struct {
 } UserInfo;
 
 typedef struct {
-    UserInfo users[MAX_USERS + 1];
+    UserInfo *users;   // max_users + 1 칸 (txn_users_table)
     int bank_funds;
 } UserDB;
 
+size_t max_users;  // 실행 시 정한 사용자 수 (txn_users.h)
 UserDB user_db;
 
 void init_user_db() {
     user_db.bank_funds = 500000;
 
-    for (int i = 1; i <= MAX_USERS; i++) {
+    user_db.users = txn_users_table(sizeof(UserInfo), max_users);
+    if (!user_db.users) {
+        perror("사용자 테이블 할당 실패");
+        exit(1);
+    }
+    txn_users_report("사용자 테이블", max_users, sizeof(UserInfo));
+    for (size_t i = 1; i <= max_users; i++) {
         user_db.users[i].user = i;
         user_db.users[i].identifier = i;
         user_db.users[i].debt = 0;
@@ -90,27 +99,32 @@ int get_limit_by_credit_rank(int rank) {
 
 int main(int argc, char *argv[]) {
     if (argc != 2) {
-        fprintf(stderr, "사용법: %s <입력파일>\n", argv[0]);
+        fprintf(stderr, "사용법: %s <입력파일|->\n", argv[0]);
         return 1;
     }
+    max_users = txn_users_count(DEFAULT_USERS);
     struct timespec start_time, end_time;
     clock_gettime(CLOCK_MONOTONIC, &start_time);
-    FILE *fp = fopen(argv[1], "r");
-    if (!fp) {
+    // 부모가 넘긴 대출 배열을 그대로 쓴다 (없으면 색인으로 대출 줄만 파싱)
+    TxnQueues *q = txn_queues_load(argv[1], 1u << TXN_LOAN);
+    if (!q) {
         perror("파일 열기 실패");
         return 1;
     }
 
     init_user_db();
-    int type, amount, name, identifier, dummy;
+    size_t loan_n;
+    const TxnRecord *loans = txn_queue(q, TXN_LOAN, &loan_n);
 
-    while (fscanf(fp, "%d", &type) == 1) {
-        if (type != 2) {
-            continue;
-        }
+    for (size_t i = 0; i < loan_n; i++) {
+        TxnRecord rec = loans[i];
 	loan_sim_load();
 	
-        fscanf(fp, "%d %d %d %d", &amount, &name, &identifier, &dummy);  // dummy = password
+        int amount = rec.amount, name = rec.user, identifier = txn_identifier(&rec);
+        if (!txn_user_valid(name, max_users)) {
+            fprintf(stderr, "[상담원] 대출 거절: 잘못된 사용자 번호 %d\n", name);
+            continue;
+        }
         UserInfo *user = &user_db.users[name];
 
         if (user->identifier != identifier) {
@@ -134,7 +148,7 @@ int main(int argc, char *argv[]) {
         }
     }
 	
-    fclose(fp);
+    txn_queues_release(q);
     clock_gettime(CLOCK_MONOTONIC, &end_time);
     double wall_sec = (end_time.tv_sec - start_time.tv_sec)
                     + (end_time.tv_nsec - start_time.tv_nsec) / 1e9;
@@ -5,8 +5,10 @@
 #include <time.h>
 #include <math.h>
 #include <sys/resource.h>
+#include "txn_queues.h"
+#include "txn_users.h"
 
-#define MAX_USERS 1000
+#define DEFAULT_USERS 1000  // 실행 시 TXN_USERS 로 바꿀 수 있다
 #define NUM_ATMS 1
 
 // 사용자 계좌 정보 구조체
@@ -19,16 +21,23 @@ typedef struct {
 
 // 전체 은행 DB 구조체
 typedef struct {
-    AccountInfo accounts[MAX_USERS + 1];
+    AccountInfo *accounts;   // max_users + 1 칸 (txn_users_table)
     int atm_funds[NUM_ATMS];
 } AccountDB;
 
+size_t max_users;  // 실행 시 정한 사용자 수 (txn_users.h)
 AccountDB acc_db;  // 전역 선언
 
 // 계좌 DB 초기화 함수
 void init_account_db() {
     acc_db.atm_funds[0] = 5000000; // ATM 자금 초기화
-    for (int i = 1; i <= MAX_USERS; i++) {
+    acc_db.accounts = txn_users_table(sizeof(AccountInfo), max_users);
+    if (!acc_db.accounts) {
+        perror("계좌 테이블 할당 실패");
+        exit(1);
+    }
+    txn_users_report("계좌 테이블", max_users, sizeof(AccountInfo));
+    for (size_t i = 1; i <= max_users; i++) {
         acc_db.accounts[i].user = i;
         acc_db.accounts[i].account = i;
         acc_db.accounts[i].password = i;
@@ -69,7 +78,7 @@ void print_cpu_time() {
 }
 
 void atm_worker_line(int amount, int user, int account, int password) {
-    if (user < 1 || user > MAX_USERS) {
+    if (!txn_user_valid(user, max_users)) {
         printf("ATM 처리 실패: 잘못된 사용자 번호 %d\n", user);
         return;
     }
@@ -99,7 +108,7 @@ void atm_worker_line(int amount, int user, int account, int password) {
 }
 
 void mobile_app_transfer(int amount, int name, int account, int password, int receiver) {
-    if (name < 1 || name > MAX_USERS || receiver < 1 || receiver > MAX_USERS) {
+    if (!txn_user_valid(name, max_users) || !txn_user_valid(receiver, max_users)) {
         printf("송금 실패: 잘못된 사용자 번호 (송금자 %d, 수신자 %d)\n", name, receiver);
         return;
     }
@@ -131,16 +140,18 @@ void mobile_app_transfer(int amount, int name, int account, int password, int re
 // 메인 함수
 int main(int argc, char *argv[]) {
     if (argc != 2) {
-        fprintf(stderr, "사용법: %s <입력파일>\n", argv[0]);
+        fprintf(stderr, "사용법: %s <입력파일|->\n", argv[0]);
         return 1;
     }
+    max_users = txn_users_count(DEFAULT_USERS);
     struct timespec start_time, end_time;
     clock_gettime(CLOCK_MONOTONIC, &start_time);
     srand(time(NULL));
     init_account_db();
 
-    FILE *fp = fopen(argv[1], "r");
-    if (!fp) {
+    // 입력은 부모가 한 번만 파싱하고, 대출 자식은 TXN_QUEUES_FD 로 결과를 받는다
+    TxnQueues *q = txn_queues_build(argv[1]);
+    if (!q) {
         perror("파일 열기 실패");
         return 1;
     }
@@ -148,26 +159,25 @@ int main(int argc, char *argv[]) {
     // 자식 프로세스: loan_handler 실행 (대출 전용)
     pid_t pid = fork();
     if (pid == 0) {
+        txn_queues_share(q);   // 대출 자식만 세그먼트를 물려받는다
         execl("./a_2_child", "a_2_child", argv[1], NULL);
         perror("exec 실패");
         exit(1);
     }
 
     // 부모 프로세스: ATM(1), 모바일 송금(3)만 처리
-    int type, amount, user, account, password, receiver;
-    while (fscanf(fp, "%d", &type) == 1) {
-        if (type == 1) {
-            fscanf(fp, "%d %d %d %d", &amount, &user, &account, &password);
-            atm_worker_line(amount, user, account, password);
-        } else if (type == 3) {
-            fscanf(fp, "%d %d %d %d %d", &amount, &user, &account, &password, &receiver);
-            mobile_app_transfer(amount, user, account, password, receiver);
-        } else {
-			continue;
-		}
+    TxnQueueIter it;
+    TxnRecord rec;
+    txn_queue_iter_init(&it, q, (1u << TXN_ATM) | (1u << TXN_TRANSFER));
+    while (txn_queue_iter_next(&it, &rec)) {
+        if (rec.type == TXN_ATM) {
+            atm_worker_line(rec.amount, rec.user, rec.account, rec.password);
+        } else if (rec.type == TXN_TRANSFER) {
+            mobile_app_transfer(rec.amount, rec.user, rec.account, rec.password, rec.receiver);
+        }
     }
 
-    fclose(fp);
+    txn_queues_release(q);
     clock_gettime(CLOCK_MONOTONIC, &end_time);
     double wall_sec = (end_time.tv_sec - start_time.tv_sec)
                     + (end_time.tv_nsec - start_time.tv_nsec) / 1e9;
@@ -5,21 +5,28 @@
 #include <sys/resource.h>
 #include <time.h>
 #include <pthread.h>
-
-#define MAX_USERS 1000
+#include <string.h>
+#include "txn_parallel.h"
+#include "txn_stream.h"
+#include "txn_users.h"
+#include "txn_atomic.h"
+#include "txn_locks.h"
+#include "txn_steal.h"
+
+#define DEFAULT_USERS 1000  // 실행 시 TXN_USERS 로 바꿀 수 있다
+#define DEFAULT_WORKERS 2   // 실행 시 --workers N 이나 TXN_WORKERS 로 바꿀 수 있다
 #define NUM_ATMS 1
-#define MAX_TASKS 10000
 
 typedef struct {
     int user;
     int account;
     int password;
-    int card_balance;
+    _Atomic int card_balance;   // ATM 은 잠금 없이 원자 연산으로 고친다 (txn_atomic.h)
 } AccountInfo;
 
 typedef struct {
-    AccountInfo accounts[MAX_USERS + 1];
-    int atm_funds[NUM_ATMS];
+    AccountInfo *accounts;   // max_users + 1 칸 (txn_users_table)
+    _Atomic int atm_funds[NUM_ATMS];
 } AccountDB;
 
 typedef struct {
@@ -30,36 +37,31 @@ typedef struct {
 } UserInfo;
 
 typedef struct {
-    UserInfo users[MAX_USERS + 1];
-    int bank_funds;
+    UserInfo *users;   // max_users + 1 칸 (txn_users_table)
+    _Atomic int bank_funds;   // 여러 워커가 다른 사용자의 대출을 동시에 처리한다 (txn_atomic.h)
 } UserDB;
 
-// 작업 구조체
-typedef struct {
-    int amount, user, account, password;
-} ATMTask;
-
-typedef struct {
-    int amount, user, identifier;
-} LoanTask;
-
-typedef struct {
-    int amount, user, account, password, receiver;
-} TransferTask;
-
+size_t max_users;  // 실행 시 정한 사용자 수 (txn_users.h)
+unsigned num_workers;  // 실행 시 정한 워커 수 (txn_workers.h)
 AccountDB acc_db;
 UserDB loan_db;
-
-ATMTask atm_tasks_even[MAX_TASKS], atm_tasks_odd[MAX_TASKS];
-LoanTask loan_tasks_even[MAX_TASKS], loan_tasks_odd[MAX_TASKS];
-TransferTask transfer_tasks_even[MAX_TASKS], transfer_tasks_odd[MAX_TASKS];
-int atm_even_cnt = 0, atm_odd_cnt = 0;
-int loan_even_cnt = 0, loan_odd_cnt = 0;
-int tr_even_cnt = 0, tr_odd_cnt = 0;
+TxnLocks *acc_locks;   // 송금이 잡는 사용자별 줄무늬 잠금 (txn_locks.h)
 
 void init_account_db() {
     acc_db.atm_funds[0] = 5000000;
-    for (int i = 1; i <= MAX_USERS; i++) {
+    acc_db.accounts = txn_users_table(sizeof(AccountInfo), max_users);
+    if (!acc_db.accounts) {
+        perror("계좌 테이블 할당 실패");
+        exit(1);
+    }
+    txn_users_report("계좌 테이블", max_users, sizeof(AccountInfo));
+    unsigned stripes = txn_locks_stripes(max_users);
+    acc_locks = aligned_alloc(TXN_LOCK_LINE, txn_locks_bytes(stripes));
+    if (!acc_locks || txn_locks_init(acc_locks, stripes) < 0) {
+        perror("잠금 표 초기화 실패");
+        exit(1);
+    }
+    for (size_t i = 1; i <= max_users; i++) {
         acc_db.accounts[i].user = i;
         acc_db.accounts[i].account = i;
         acc_db.accounts[i].password = i;
@@ -69,7 +71,13 @@ void init_account_db() {
 
 void init_user_db() {
     loan_db.bank_funds = 500000;
-    for (int i = 1; i <= MAX_USERS; i++) {
+    loan_db.users = txn_users_table(sizeof(UserInfo), max_users);
+    if (!loan_db.users) {
+        perror("사용자 테이블 할당 실패");
+        exit(1);
+    }
+    txn_users_report("사용자 테이블", max_users, sizeof(UserInfo));
+    for (size_t i = 1; i <= max_users; i++) {
         loan_db.users[i].user = i;
         loan_db.users[i].identifier = i;
         loan_db.users[i].debt = 0;
@@ -130,7 +138,7 @@ void loan_sim_load() {
 
 
 void atm_worker_line(int amount, int user, int account, int password) {
-    if (user < 1 || user > MAX_USERS) {
+    if (!txn_user_valid(user, max_users)) {
         printf("ATM 처리 실패: 잘못된 사용자 번호 %d\n", user);
         return;
     }
@@ -143,15 +151,14 @@ void atm_worker_line(int amount, int user, int account, int password) {
         return;
     }
 
+    // 모든 워커가 같은 ATM 현금을 고치므로 값마다 원자 연산으로 확인하고 고친다.
+    // 잔액과 현금은 따로 바뀌므로 도중에는 어긋나 보일 수 있다 (txn_atomic.h)
     if (amount >= 0) {
-        info->card_balance += amount;
-        acc_db.atm_funds[0] += amount;
+        txn_atm_deposit(&info->card_balance, &acc_db.atm_funds[0], amount);
         printf("ATM 입금: 사용자 %d 금액 %d원\n", user, amount);
     } else {
         int withdraw = -amount;
-        if (withdraw <= info->card_balance && withdraw <= acc_db.atm_funds[0]) {
-            info->card_balance -= withdraw;
-            acc_db.atm_funds[0] -= withdraw;
+        if (txn_atm_withdraw(&info->card_balance, &acc_db.atm_funds[0], withdraw) == TXN_ATM_OK) {
             printf("ATM 출금: 사용자 %d 금액 %d원\n", user, withdraw);
         } else {
             printf("ATM 출금 실패: 사용자 %d 잔액 부족\n", user);
@@ -160,7 +167,7 @@ void atm_worker_line(int amount, int user, int account, int password) {
 }
 
 void mobile_app_transfer(int amount, int name, int account, int password, int receiver) {
-    if (name < 1 || name > MAX_USERS || receiver < 1 || receiver > MAX_USERS) {
+    if (!txn_user_valid(name, max_users) || !txn_user_valid(receiver, max_users)) {
         printf("송금 실패: 잘못된 사용자 번호 (송금자 %d, 수신자 %d)\n", name, receiver);
         return;
     }
@@ -175,22 +182,28 @@ void mobile_app_transfer(int amount, int name, int account, int password, int re
         return;
     }
 
-    if (sender->card_balance < real_amount) {
+    // 수신자는 다른 워커 몫일 수 있으므로 두 계좌의 줄무늬를 정해진 순서로 함께 잡는다.
+    // ATM 은 잠금 없이 같은 잔액을 고치므로 빼기와 더하기도 원자 연산으로 한다.
+    TxnLock *held[2];
+    txn_locks_lock_pair(acc_locks, name, receiver, held);
+    int ok = txn_atomic_take(&sender->card_balance, real_amount);
+    if (ok)
+        atomic_fetch_add_explicit(&recv->card_balance, real_amount, memory_order_relaxed);
+    int s_after = sender->card_balance, r_after = recv->card_balance;
+    txn_locks_unlock_pair(held);
+
+    if (!ok) {
         printf("송금 실패: 잔액 부족 (송금자 %d번, 필요: %d, 보유: %d)\n\n",
-               name, real_amount, sender->card_balance);
+               name, real_amount, s_after);
         return;
     }
-
-    sender->card_balance -= real_amount;
-    recv->card_balance   += real_amount;
-
     printf("송금 성공: %d번 → %d번, 금액: %d\n", name, receiver, real_amount);
-    printf("송금자 남은 잔액: %d\n", sender->card_balance);
-    printf("수신자 새로운 잔액: %d\n\n", recv->card_balance);
+    printf("송금자 남은 잔액: %d\n", s_after);
+    printf("수신자 새로운 잔액: %d\n\n", r_after);
 }
 
 void handle_single_loan(int user, int amount, int identifier) {
-    if (user < 1 || user > MAX_USERS) {
+    if (!txn_user_valid(user, max_users)) {
         printf("대출 실패: 잘못된 사용자 번호 %d\n", user);
         return;
     }
@@ -204,9 +217,8 @@ void handle_single_loan(int user, int amount, int identifier) {
         return;
     }
 
-    if (loan_db.bank_funds >= amount) {
-        info->debt += amount;
-        loan_db.bank_funds -= amount;
+    if (txn_atomic_take(&loan_db.bank_funds, amount)) {
+        info->debt += amount;   // 한 사용자의 거래는 한 워커만 처리한다
         printf("대출 성공: 사용자 %d 금액 %d\n", user, amount);
     } else {
         printf("대출 실패: 은행 자금 부족\n");
@@ -214,19 +226,20 @@ void handle_single_loan(int user, int amount, int identifier) {
 }
 
 
-void *worker_thread(void *arg) {
-    for (int i = 0; i < atm_odd_cnt; i++)
-        atm_worker_line(atm_tasks_odd[i].amount, atm_tasks_odd[i].user,
-                        atm_tasks_odd[i].account, atm_tasks_odd[i].password);
-
-    for (int i = 0; i < loan_odd_cnt; i++)
-        handle_single_loan(loan_tasks_odd[i].user, loan_tasks_odd[i].amount, loan_tasks_odd[i].identifier);
+void run_task(const TxnRecord *r) {
+    if (r->type == TXN_ATM)
+        atm_worker_line(r->amount, r->user, r->account, r->password);
+    else if (r->type == TXN_LOAN)
+        handle_single_loan(r->user, r->amount, txn_identifier(r));
+    else
+        mobile_app_transfer(r->amount, r->user, r->account, r->password, r->receiver);
+}
 
-    for (int i = 0; i < tr_odd_cnt; i++)
-        mobile_app_transfer(transfer_tasks_odd[i].amount, transfer_tasks_odd[i].user,
-                            transfer_tasks_odd[i].account, transfer_tasks_odd[i].password,
-                            transfer_tasks_odd[i].receiver);
-    return NULL;
+// 사용자 한 명의 묶음 (ATM → 대출 → 송금, 각각 파일 순서)
+void run_group(const TxnRecord *recs, size_t n, void *ctx) {
+    (void)ctx;
+    for (size_t i = 0; i < n; i++)
+        run_task(&recs[i]);
 }
 
 void print_cpu_time() {
@@ -240,68 +253,124 @@ void print_cpu_time() {
     printf("  🕒 총합: %.6f 초\n", user_sec + sys_sec);
 }
 
+// ---------- 일괄 모드: 전부 파싱한 뒤 실행 ----------
+
+int run_batch(const char *filename) {
+    // 입력을 코어 수만큼 나눠 병렬 파싱한다 (type 별 파일 순서 유지)
+    TxnParsed parsed;
+    if (txn_parse_parallel(filename, txn_parse_threads(), &parsed) < 0) {
+        perror("파일 열기 실패");
+        return -1;
+    }
+
+    // 사용자별로 묶어 워커들이 훔쳐 가며 처리한다 (txn_steal.h)
+    const TxnRecord *spans[3] = {parsed.recs[TXN_ATM], parsed.recs[TXN_LOAN],
+                                 parsed.recs[TXN_TRANSFER]};
+    size_t counts[3] = {parsed.count[TXN_ATM], parsed.count[TXN_LOAN],
+                        parsed.count[TXN_TRANSFER]};
+    TxnGroups groups;
+    int failed = txn_groups_build(&groups, spans, counts, 3);
+    txn_parsed_report(&parsed);
+    txn_parsed_free(&parsed);
+    if (failed < 0) {
+        perror("작업 묶기 실패");
+        return -1;
+    }
+
+    TxnSteal pool;
+    failed = txn_steal_run(&pool, &groups, num_workers, run_group, NULL);
+    if (failed < 0)
+        perror("워커 생성 실패");
+    else
+        txn_steal_report(&pool);
+    txn_steal_free(&pool);
+    txn_groups_free(&groups);
+    return failed;
+}
+
+// ---------- 스트리밍 모드 ----------
+
+void *stream_worker(void *arg) {
+    TxnStream *q = arg;
+    TxnRecord batch[TXN_STREAM_BATCH];
+    size_t n;
+    while ((n = txn_stream_pop(q, batch, TXN_STREAM_BATCH)) > 0) {
+        for (size_t i = 0; i < n; i++)
+            run_task(&batch[i]);
+    }
+    return NULL;
+}
+
+// 생산자 스레드가 파싱하는 동안 워커가 바로 처리를 시작한다
+int run_streaming(const char *filename, unsigned long long start_ns) {
+    TxnReader rd;
+    if (txn_reader_open(&rd, filename) < 0) {
+        perror("파일 열기 실패");
+        return -1;
+    }
+    TxnStream *qs = txn_stream_create(num_workers);
+    if (!qs) {
+        perror("큐 생성 실패");
+        txn_reader_close(&rd);
+        return -1;
+    }
+
+    // 묶음을 미리 알 수 없으므로 사용자 번호 % 워커 수로 큐를 고른다 (훔치기 없음)
+    TxnProducer prod = {.rd = &rd, .queues = qs, .n = (int)num_workers};
+    pthread_t ptid, tids[TXN_WORKERS_MAX];
+    pthread_create(&ptid, NULL, txn_stream_producer, &prod);
+    for (unsigned w = 1; w < num_workers; w++)
+        pthread_create(&tids[w], NULL, stream_worker, &qs[w]);
+    stream_worker(&qs[0]);
+    for (unsigned w = 1; w < num_workers; w++)
+        pthread_join(tids[w], NULL);
+    pthread_join(ptid, NULL);
+
+    // 읽기 오류면 처리한 합계는 잘린 입력의 것이다
+    int failed = rd.err != 0;
+    if (!failed) {
+        txn_reader_report(&rd);
+        txn_stream_report(qs, num_workers, start_ns);
+    }
+    txn_stream_destroy(qs, num_workers);
+    txn_reader_close(&rd);
+    return failed ? -1 : 0;
+}
+
 int main(int argc, char *argv[]) {
-    if (argc != 2) {
-        fprintf(stderr, "사용법: %s <입력파일>\n", argv[0]);
+    int stream_mode = 0;
+    const char *filename = NULL;
+    num_workers = txn_workers_arg(&argc, argv, DEFAULT_WORKERS);
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--stream") == 0)
+            stream_mode = 1;
+        else
+            filename = argv[i];
+    }
+    if (!filename || !num_workers) {
+        fprintf(stderr, "사용법: %s [--stream] [--workers N] <입력파일|->\n", argv[0]);
         return 1;
     }
+    max_users = txn_users_count(DEFAULT_USERS);
 
-    const char *filename = argv[1];
     srand(time(NULL));
     init_account_db();
     init_user_db();
     struct timespec start_time, end_time;
     clock_gettime(CLOCK_MONOTONIC, &start_time);
-    FILE *fp = fopen(filename, "r");
-    if (!fp) {
-        perror("파일 열기 실패");
+    unsigned long long start_ns = txn_now_ns();
+    if (stream_mode) {
+        if (run_streaming(filename, start_ns) < 0)
+            return 1;
+    } else if (run_batch(filename) < 0) {
         return 1;
     }
-
-    int type, amount, user, account, password, receiver, identifier;
-    while (fscanf(fp, "%d", &type) == 1) {
-        if (type == 1 && fscanf(fp, "%d %d %d %d", &amount, &user, &account, &password) == 4) {
-            ATMTask task = {amount, user, account, password};
-            if (user % 2 == 0)
-                atm_tasks_even[atm_even_cnt++] = task;
-            else
-                atm_tasks_odd[atm_odd_cnt++] = task;
-        } else if (type == 2 && fscanf(fp, "%d %d %d", &amount, &user, &identifier) == 3) {
-            LoanTask task = {amount, user, identifier};
-            if (user % 2 == 0)
-                loan_tasks_even[loan_even_cnt++] = task;
-            else
-                loan_tasks_odd[loan_odd_cnt++] = task;
-        } else if (type == 3 && fscanf(fp, "%d %d %d %d %d", &amount, &user, &account, &password, &receiver) == 5) {
-            TransferTask task = {amount, user, account, password, receiver};
-            if (user % 2 == 0)
-                transfer_tasks_even[tr_even_cnt++] = task;
-            else
-                transfer_tasks_odd[tr_odd_cnt++] = task;
-        } else {
-            fscanf(fp, "%*[^\n]");
-        }
-    }
-    fclose(fp);
-
-    pthread_t tid;
-    pthread_create(&tid, NULL, worker_thread, NULL);
-
-    for (int i = 0; i < atm_even_cnt; i++)
-        atm_worker_line(atm_tasks_even[i].amount, atm_tasks_even[i].user,
-                        atm_tasks_even[i].account, atm_tasks_even[i].password);
-    for (int i = 0; i < loan_even_cnt; i++)
-        handle_single_loan(loan_tasks_even[i].user, loan_tasks_even[i].amount, loan_tasks_even[i].identifier);
-    for (int i = 0; i < tr_even_cnt; i++)
-        mobile_app_transfer(transfer_tasks_even[i].amount, transfer_tasks_even[i].user,
-                            transfer_tasks_even[i].account, transfer_tasks_even[i].password,
-                            transfer_tasks_even[i].receiver);
-
-    pthread_join(tid, NULL);
     clock_gettime(CLOCK_MONOTONIC, &end_time);
 
     double wall_sec = (end_time.tv_sec - start_time.tv_sec)
                     + (end_time.tv_nsec - start_time.tv_nsec) / 1e9;
+    TxnLockStats st = txn_locks_stats(acc_locks);
+    txn_lock_stats_report(&st, "송금 계좌");
     print_cpu_time();
     printf("⏱ 전체 실행 시간 (Wall-clock): %.6f 초\n\n", wall_sec);
     return 0;
@@ -5,11 +5,16 @@
 #include <sys/resource.h>
 #include <time.h>
 #include <pthread.h>
+#include <string.h>
+#include "txn_parallel.h"
+#include "txn_stream.h"
+#include "txn_users.h"
+#include "txn_dispatch.h"
 #include <sys/wait.h>  // waitpid
 #include <unistd.h>    // fork
-#define MAX_USERS 1000
+#define DEFAULT_USERS 1000  // 실행 시 TXN_USERS 로 바꿀 수 있다
+#define DEFAULT_WORKERS 2   // 워커 프로세스 수, --workers N 으로 바꿀 수 있다
 #define NUM_ATMS 1
-#define MAX_TASKS 10000
 
 typedef struct {
     int user;
@@ -19,7 +24,7 @@ typedef struct {
 } AccountInfo;
 
 typedef struct {
-    AccountInfo accounts[MAX_USERS + 1];
+    AccountInfo *accounts;   // max_users + 1 칸 (txn_users_table)
     int atm_funds[NUM_ATMS];
 } AccountDB;
 
@@ -31,36 +36,24 @@ typedef struct {
 } UserInfo;
 
 typedef struct {
-    UserInfo users[MAX_USERS + 1];
+    UserInfo *users;   // max_users + 1 칸 (txn_users_table)
     int bank_funds;
 } UserDB;
 
-// 작업 구조체
-typedef struct {
-    int amount, user, account, password;
-} ATMTask;
-
-typedef struct {
-    int amount, user, identifier;
-} LoanTask;
-
-typedef struct {
-    int amount, user, account, password, receiver;
-} TransferTask;
-
+size_t max_users;  // 실행 시 정한 사용자 수 (txn_users.h)
+unsigned num_workers;  // 실행 시 정한 워커 수 (txn_workers.h)
 AccountDB acc_db;
 UserDB loan_db;
 
-ATMTask atm_tasks_even[MAX_TASKS], atm_tasks_odd[MAX_TASKS];
-LoanTask loan_tasks_even[MAX_TASKS], loan_tasks_odd[MAX_TASKS];
-TransferTask transfer_tasks_even[MAX_TASKS], transfer_tasks_odd[MAX_TASKS];
-int atm_even_cnt = 0, atm_odd_cnt = 0;
-int loan_even_cnt = 0, loan_odd_cnt = 0;
-int tr_even_cnt = 0, tr_odd_cnt = 0;
-
 void init_account_db() {
     acc_db.atm_funds[0] = 5000000;
-    for (int i = 1; i <= MAX_USERS; i++) {
+    acc_db.accounts = txn_users_table(sizeof(AccountInfo), max_users);
+    if (!acc_db.accounts) {
+        perror("계좌 테이블 할당 실패");
+        exit(1);
+    }
+    txn_users_report("계좌 테이블", max_users, sizeof(AccountInfo));
+    for (size_t i = 1; i <= max_users; i++) {
         acc_db.accounts[i].user = i;
         acc_db.accounts[i].account = i;
         acc_db.accounts[i].password = i;
@@ -70,7 +63,13 @@ void init_account_db() {
 
 void init_user_db() {
     loan_db.bank_funds = 500000;
-    for (int i = 1; i <= MAX_USERS; i++) {
+    loan_db.users = txn_users_table(sizeof(UserInfo), max_users);
+    if (!loan_db.users) {
+        perror("사용자 테이블 할당 실패");
+        exit(1);
+    }
+    txn_users_report("사용자 테이블", max_users, sizeof(UserInfo));
+    for (size_t i = 1; i <= max_users; i++) {
         loan_db.users[i].user = i;
         loan_db.users[i].identifier = i;
         loan_db.users[i].debt = 0;
@@ -131,6 +130,10 @@ void loan_sim_load() {
 
 void atm_worker_line(int amount, int user, int account, int password) {
     sim_load();
+    if (!txn_user_valid(user, max_users)) {
+        printf("ATM 처리 실패: 잘못된 사용자 번호 %d\n", user);
+        return;
+    }
     AccountInfo *info = &acc_db.accounts[user];
     if (info->account != account || info->password != password) {
         printf("ATM 인증 실패: 사용자 %d\n", user);
@@ -154,7 +157,7 @@ void atm_worker_line(int amount, int user, int account, int password) {
 
 void handle_single_loan(int user, int amount, int identifier) {
     loan_sim_load();
-    if (user < 1 || user > MAX_USERS) return;
+    if (!txn_user_valid(user, max_users)) return;
     UserInfo *info = &loan_db.users[user];
     if (info->identifier != identifier) {
         printf("대출 실패: 사용자 인증 실패 (%d번)\n", user);
@@ -171,6 +174,10 @@ void handle_single_loan(int user, int amount, int identifier) {
 
 void mobile_app_transfer(int amount, int name, int account, int password, int receiver) {
     sim_load();
+    if (!txn_user_valid(name, max_users) || !txn_user_valid(receiver, max_users)) {
+        printf("송금 실패: 잘못된 사용자 번호 (송금자 %d, 수신자 %d)\n", name, receiver);
+        return;
+    }
     AccountInfo *sender = &acc_db.accounts[name];
     AccountInfo *recv = &acc_db.accounts[receiver];
     int real_amount = abs(amount);
@@ -190,19 +197,21 @@ void mobile_app_transfer(int amount, int name, int account, int password, int re
     printf("송금 성공: %d번 → %d번, 금액: %d\n", name, receiver, real_amount);
 }
 
-void *worker_thread(void *arg) {
-    for (int i = 0; i < atm_odd_cnt; i++)
-        atm_worker_line(atm_tasks_odd[i].amount, atm_tasks_odd[i].user,
-                        atm_tasks_odd[i].account, atm_tasks_odd[i].password);
-
-    for (int i = 0; i < loan_odd_cnt; i++)
-        handle_single_loan(loan_tasks_odd[i].user, loan_tasks_odd[i].amount, loan_tasks_odd[i].identifier);
+void run_task(const TxnRecord *r) {
+    if (r->type == TXN_ATM)
+        atm_worker_line(r->amount, r->user, r->account, r->password);
+    else if (r->type == TXN_LOAN)
+        handle_single_loan(r->user, r->amount, txn_identifier(r));
+    else
+        mobile_app_transfer(r->amount, r->user, r->account, r->password, r->receiver);
+}
 
-    for (int i = 0; i < tr_odd_cnt; i++)
-        mobile_app_transfer(transfer_tasks_odd[i].amount, transfer_tasks_odd[i].user,
-                            transfer_tasks_odd[i].account, transfer_tasks_odd[i].password,
-                            transfer_tasks_odd[i].receiver);
-    return NULL;
+// 워커 w 의 몫을 처리한다 (ATM → 대출 → 송금, 각각 파일 순서)
+void run_tasks(const TxnBuckets *b, unsigned w) {
+    size_t n;
+    const TxnRecord *recs = txn_bucket(b, w, &n);
+    for (size_t i = 0; i < n; i++)
+        run_task(&recs[i]);
 }
 
 void print_cpu_time() {
@@ -216,89 +225,154 @@ void print_cpu_time() {
     printf("  🕒 총합: %.6f 초\n", user_sec + sys_sec);
 }
 
-int main(int argc, char *argv[]) {
-    if (argc != 2) {
-        fprintf(stderr, "사용법: %s <입력파일>\n", argv[0]);
-        return 1;
-    }
-    struct timespec start_time, end_time;
-    clock_gettime(CLOCK_MONOTONIC, &start_time);
-    const char *filename = argv[1];
-    srand(time(NULL));
-    init_account_db();
-    init_user_db();
+// ---------- 일괄 모드: 전부 파싱한 뒤 실행 ----------
 
-    FILE *fp = fopen(filename, "r");
-    if (!fp) {
+int run_batch(const char *filename) {
+    // 입력을 코어 수만큼 나눠 병렬 파싱한다 (type 별 파일 순서 유지)
+    TxnParsed parsed;
+    if (txn_parse_parallel(filename, txn_parse_threads(), &parsed) < 0) {
         perror("파일 열기 실패");
-        return 1;
+        return -1;
     }
 
-    int type, amount, user, account, password, receiver, identifier;
-    while (fscanf(fp, "%d", &type) == 1) {
-        if (type == 1 && fscanf(fp, "%d %d %d %d", &amount, &user, &account, &password) == 4) {
-            ATMTask task = {amount, user, account, password};
-            if (user % 2 == 0)
-                atm_tasks_even[atm_even_cnt++] = task;
-            else
-                atm_tasks_odd[atm_odd_cnt++] = task;
-        } else if (type == 2 && fscanf(fp, "%d %d %d", &amount, &user, &identifier) == 3) {
-            LoanTask task = {amount, user, identifier};
-            if (user % 2 == 0)
-                loan_tasks_even[loan_even_cnt++] = task;
-            else
-                loan_tasks_odd[loan_odd_cnt++] = task;
-        } else if (type == 3 && fscanf(fp, "%d %d %d %d %d", &amount, &user, &account, &password, &receiver) == 5) {
-            TransferTask task = {amount, user, account, password, receiver};
-            if (user % 2 == 0)
-                transfer_tasks_even[tr_even_cnt++] = task;
-            else
-                transfer_tasks_odd[tr_odd_cnt++] = task;
-        } else {
-            fscanf(fp, "%*[^\n]");
+    // type 별 배열을 워커별 연속 배열로 한 번에 나눈다 (txn_dispatch.h)
+    const TxnRecord *spans[3] = {parsed.recs[TXN_ATM], parsed.recs[TXN_LOAN],
+                                 parsed.recs[TXN_TRANSFER]};
+    size_t counts[3] = {parsed.count[TXN_ATM], parsed.count[TXN_LOAN],
+                        parsed.count[TXN_TRANSFER]};
+    TxnBuckets work;
+    int failed = txn_buckets_build(&work, spans, counts, 3, num_workers);
+    txn_parsed_report(&parsed);
+    txn_parsed_free(&parsed);
+    if (failed < 0) {
+        perror("작업 나누기 실패");
+        return -1;
+    }
+    txn_buckets_report(&work, "작업");
+
+    // 👶 자식 프로세스 w (1 ≤ w < num_workers): user % num_workers == w 인 사용자 처리
+    unsigned forked = 0;
+    for (unsigned w = 1; w < num_workers; w++, forked++) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("fork 실패");
+            failed = -1;
+            break;
+        }
+        if (pid == 0) {
+            run_tasks(&work, w);
+            exit(0);  // 자식 프로세스 종료
         }
     }
-    fclose(fp);
 
+    // 👨 부모 프로세스: user % num_workers == 0 인 사용자 처리
+    if (failed == 0)
+        run_tasks(&work, 0);
 
-    pid_t pid = fork();
-
-    if (pid < 0) {
-        perror("fork 실패");
-        return 1;
-    }
+    // 자식 프로세스 종료 대기
+    for (unsigned w = 0; w < forked; w++)
+        wait(NULL);
+    txn_buckets_free(&work);
+    return failed;
+}
 
-    if (pid == 0) {
-        // 👶 자식 프로세스: 홀수 사용자 처리
-        for (int i = 0; i < atm_odd_cnt; i++)
-            atm_worker_line(atm_tasks_odd[i].amount, atm_tasks_odd[i].user,
-                            atm_tasks_odd[i].account, atm_tasks_odd[i].password);
+// ---------- 스트리밍 모드 ----------
 
-        for (int i = 0; i < loan_odd_cnt; i++)
-            handle_single_loan(loan_tasks_odd[i].user, loan_tasks_odd[i].amount, loan_tasks_odd[i].identifier);
+void *stream_worker(void *arg) {
+    TxnStream *q = arg;
+    TxnRecord batch[TXN_STREAM_BATCH];
+    size_t n;
+    while ((n = txn_stream_pop(q, batch, TXN_STREAM_BATCH)) > 0) {
+        for (size_t i = 0; i < n; i++)
+            run_task(&batch[i]);
+    }
+    return NULL;
+}
 
-        for (int i = 0; i < tr_odd_cnt; i++)
-            mobile_app_transfer(transfer_tasks_odd[i].amount, transfer_tasks_odd[i].user,
-                                transfer_tasks_odd[i].account, transfer_tasks_odd[i].password,
-                                transfer_tasks_odd[i].receiver);
-        exit(0);  // 자식 프로세스 종료
+// 생산자 스레드가 파싱하는 동안 워커가 바로 처리를 시작한다
+int run_streaming(const char *filename, unsigned long long start_ns) {
+    TxnReader rd;
+    if (txn_reader_open(&rd, filename) < 0) {
+        perror("파일 열기 실패");
+        return -1;
+    }
+    TxnStream *qs = txn_stream_create(num_workers);
+    if (!qs) {
+        perror("큐 생성 실패");
+        txn_reader_close(&rd);
+        return -1;
     }
 
-    // 👨 부모 프로세스: 짝수 사용자 처리
-    for (int i = 0; i < atm_even_cnt; i++)
-        atm_worker_line(atm_tasks_even[i].amount, atm_tasks_even[i].user,
-                        atm_tasks_even[i].account, atm_tasks_even[i].password);
+    // 큐는 공유 매핑이라 fork 된 자식도 같은 큐를 본다. 생산자 스레드는 fork 뒤에 띄운다.
+    unsigned forked = 0;
+    for (unsigned w = 1; w < num_workers; w++, forked++) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("fork 실패");
+            // 이미 띄운 자식은 빈 큐가 닫힌 것을 보고 끝난다
+            for (unsigned i = 0; i < num_workers; i++)
+                txn_stream_close(&qs[i]);
+            for (unsigned i = 0; i < forked; i++)
+                wait(NULL);
+            txn_stream_destroy(qs, num_workers);
+            txn_reader_close(&rd);
+            return -1;
+        }
+        if (pid == 0) {
+            // 👶 자식 프로세스 w: user % num_workers == w 인 사용자 처리
+            stream_worker(&qs[w]);
+            exit(0);
+        }
+    }
 
-    for (int i = 0; i < loan_even_cnt; i++)
-        handle_single_loan(loan_tasks_even[i].user, loan_tasks_even[i].amount, loan_tasks_even[i].identifier);
+    // 👨 부모 프로세스: 생산자 스레드 + user % num_workers == 0 인 사용자 처리
+    TxnProducer prod = {.rd = &rd, .queues = qs, .n = (int)num_workers};
+    pthread_t ptid;
+    pthread_create(&ptid, NULL, txn_stream_producer, &prod);
+    stream_worker(&qs[0]);
+    pthread_join(ptid, NULL);
+    for (unsigned i = 0; i < forked; i++)
+        wait(NULL);
+
+    // 읽기 오류면 처리한 합계는 잘린 입력의 것이다
+    int failed = rd.err != 0;
+    if (!failed) {
+        txn_reader_report(&rd);
+        txn_stream_report(qs, num_workers, start_ns);
+    }
+    txn_stream_destroy(qs, num_workers);
+    txn_reader_close(&rd);
+    return failed ? -1 : 0;
+}
 
-    for (int i = 0; i < tr_even_cnt; i++)
-        mobile_app_transfer(transfer_tasks_even[i].amount, transfer_tasks_even[i].user,
-                            transfer_tasks_even[i].account, transfer_tasks_even[i].password,
-                            transfer_tasks_even[i].receiver);
+int main(int argc, char *argv[]) {
+    int stream_mode = 0;
+    const char *filename = NULL;
+    num_workers = txn_workers_arg(&argc, argv, DEFAULT_WORKERS);
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--stream") == 0)
+            stream_mode = 1;
+        else
+            filename = argv[i];
+    }
+    if (!filename || !num_workers) {
+        fprintf(stderr, "사용법: %s [--stream] [--workers N] <입력파일|->\n", argv[0]);
+        return 1;
+    }
+    max_users = txn_users_count(DEFAULT_USERS);
+    struct timespec start_time, end_time;
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+    unsigned long long start_ns = txn_now_ns();
+    srand(time(NULL));
+    init_account_db();
+    init_user_db();
 
-    // 자식 프로세스 종료 대기
-    wait(NULL);
+    if (stream_mode) {
+        if (run_streaming(filename, start_ns) < 0)
+            return 1;
+    } else if (run_batch(filename) < 0) {
+        return 1;
+    }
 
     clock_gettime(CLOCK_MONOTONIC, &end_time);
     double wall_sec = (end_time.tv_sec - start_time.tv_sec)
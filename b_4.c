@@ -5,8 +5,10 @@
 #include <sys/resource.h>
 #include <time.h>
 #include <sys/wait.h>
+#include "txn_queues.h"
+#include "txn_users.h"
 
-#define MAX_USERS 1000
+#define DEFAULT_USERS 1000  // 실행 시 TXN_USERS 로 바꿀 수 있다
 #define NUM_ATMS 1
 
 // ---------- 구조체 정의 ----------
@@ -19,7 +21,7 @@ typedef struct {
 } AccountInfo;
 
 typedef struct {
-    AccountInfo accounts[MAX_USERS + 1];
+    AccountInfo *accounts;   // max_users + 1 칸 (txn_users_table)
     int atm_funds[NUM_ATMS];
 } AccountDB;
 
@@ -31,12 +33,13 @@ typedef struct {
 } UserInfo;
 
 typedef struct {
-    UserInfo users[MAX_USERS + 1];
+    UserInfo *users;   // max_users + 1 칸 (txn_users_table)
     int bank_funds;
 } UserDB;
 
 // ---------- 전역 변수 ----------
 
+size_t max_users;  // 실행 시 정한 사용자 수 (txn_users.h)
 AccountDB acc_db;
 UserDB loan_db;
 
@@ -44,7 +47,13 @@ UserDB loan_db;
 
 void init_account_db() {
     acc_db.atm_funds[0] = 5000000;
-    for (int i = 1; i <= MAX_USERS; i++) {
+    acc_db.accounts = txn_users_table(sizeof(AccountInfo), max_users);
+    if (!acc_db.accounts) {
+        perror("계좌 테이블 할당 실패");
+        exit(1);
+    }
+    txn_users_report("계좌 테이블", max_users, sizeof(AccountInfo));
+    for (size_t i = 1; i <= max_users; i++) {
         acc_db.accounts[i].user = i;
         acc_db.accounts[i].account = i;
         acc_db.accounts[i].password = i;
@@ -54,7 +63,13 @@ void init_account_db() {
 
 void init_user_db() {
     loan_db.bank_funds = 500000;
-    for (int i = 1; i <= MAX_USERS; i++) {
+    loan_db.users = txn_users_table(sizeof(UserInfo), max_users);
+    if (!loan_db.users) {
+        perror("사용자 테이블 할당 실패");
+        exit(1);
+    }
+    txn_users_report("사용자 테이블", max_users, sizeof(UserInfo));
+    for (size_t i = 1; i <= max_users; i++) {
         loan_db.users[i].user = i;
         loan_db.users[i].identifier = i;
         loan_db.users[i].debt = 0;
@@ -130,6 +145,10 @@ void print_cpu_time() {
 
 void atm_worker_line(int amount, int user, int account, int password) {
     sim_load();
+    if (!txn_user_valid(user, max_users)) {
+        printf("ATM 처리 실패: 잘못된 사용자 번호 %d\n", user);
+        return;
+    }
     AccountInfo *info = &acc_db.accounts[user];
 
     if (info->account != account || info->password != password) {
@@ -155,6 +174,10 @@ void atm_worker_line(int amount, int user, int account, int password) {
 
 void mobile_app_transfer(int amount, int name, int account, int password, int receiver) {
     sim_load();
+    if (!txn_user_valid(name, max_users) || !txn_user_valid(receiver, max_users)) {
+        printf("송금 실패: 잘못된 사용자 번호 (송금자 %d, 수신자 %d)\n", name, receiver);
+        return;
+    }
     AccountInfo *sender = &acc_db.accounts[name];
     AccountInfo *recv   = &acc_db.accounts[receiver];
     int real_amount = abs(amount);
@@ -180,7 +203,7 @@ void mobile_app_transfer(int amount, int name, int account, int password, int re
 
 void handle_single_loan(int user, int amount, int identifier) {
     loan_sim_load();
-    if (user < 1 || user > MAX_USERS) return;
+    if (!txn_user_valid(user, max_users)) return;
 
     UserInfo *info = &loan_db.users[user];
     if (info->identifier != identifier) {
@@ -201,9 +224,10 @@ void handle_single_loan(int user, int amount, int identifier) {
 
 int main(int argc, char *argv[]) {
     if (argc != 2) {
-        fprintf(stderr, "사용법: %s <입력파일>\n", argv[0]);
+        fprintf(stderr, "사용법: %s <입력파일|->\n", argv[0]);
         return 1;
     }
+    max_users = txn_users_count(DEFAULT_USERS);
     struct timespec start_time, end_time;
     clock_gettime(CLOCK_MONOTONIC, &start_time);
     const char *filename = argv[1];
@@ -213,6 +237,13 @@ int main(int argc, char *argv[]) {
 
 
 
+    // 입력은 fork 전에 한 번만 파싱하고, 자식은 대출 배열만 물려받는다
+    TxnQueues *q = txn_queues_build(filename);
+    if (!q) {
+        perror("파일 열기 실패");
+        return 1;
+    }
+
     pid_t pid = fork();
 
     if (pid < 0) {
@@ -222,51 +253,28 @@ int main(int argc, char *argv[]) {
 
     // 자식 프로세스 → loan 처리 (type == 2)
     if (pid == 0) {
-        FILE *fp = fopen(filename, "r");
-        if (!fp) {
-            perror("자식 파일 열기 실패");
-            exit(1);
-        }
-
-        int type, amount, user, account, password, receiver, identifier;
-        while (fscanf(fp, "%d", &type) == 1) {
-            if (type == 2) {
-                fscanf(fp, "%d %d %d", &amount, &user, &identifier);
-                handle_single_loan(user, amount, identifier);
-            } else {
-                // 나머지 줄 스킵
-                char buf[256];
-                fgets(buf, sizeof(buf), fp);
-            }
+        size_t loan_n;
+        const TxnRecord *loans = txn_queue(q, TXN_LOAN, &loan_n);
+        for (size_t i = 0; i < loan_n; i++) {
+            handle_single_loan(loans[i].user, loans[i].amount, txn_identifier(&loans[i]));
         }
 
-        fclose(fp);
         exit(0);  // 자식 프로세스 정상 종료
     }
 
     // 부모 프로세스 → ATM(type == 1) / 송금(type == 3) 처리
-    FILE *fp = fopen(filename, "r");
-    if (!fp) {
-        perror("부모 파일 열기 실패");
-        return 1;
-    }
-
-    int type, amount, user, account, password, receiver, identifier;
-    while (fscanf(fp, "%d", &type) == 1) {
-        if (type == 1) {
-            fscanf(fp, "%d %d %d %d", &amount, &user, &account, &password);
-            atm_worker_line(amount, user, account, password);
-        } else if (type == 3) {
-            fscanf(fp, "%d %d %d %d %d", &amount, &user, &account, &password, &receiver);
-            mobile_app_transfer(amount, user, account, password, receiver);
-        } else {
-            // 나머지 줄 스킵
-            char buf[256];
-            fgets(buf, sizeof(buf), fp);
+    TxnQueueIter it;
+    TxnRecord rec;
+    txn_queue_iter_init(&it, q, (1u << TXN_ATM) | (1u << TXN_TRANSFER));
+    while (txn_queue_iter_next(&it, &rec)) {
+        if (rec.type == TXN_ATM) {
+            atm_worker_line(rec.amount, rec.user, rec.account, rec.password);
+        } else if (rec.type == TXN_TRANSFER) {
+            mobile_app_transfer(rec.amount, rec.user, rec.account, rec.password, rec.receiver);
         }
     }
 
-    fclose(fp);
+    txn_queues_release(q);
 
     // 자식 종료 대기
     wait(NULL);
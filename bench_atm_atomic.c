@@ -0,0 +1,173 @@
+// bench_atm_atomic.c
+// b_2.c / c_2.c 의 ATM 처리(계좌 잔액과 ATM 현금을 함께 고치는 입출금)를
+// 뮤텍스 하나로 감쌀 때와 txn_atomic.h 의 원자 연산으로 할 때를 스레드 1 ~ 16 개에서 비교한다.
+//
+//   gcc -O2 bench_atm_atomic.c -o bench_atm_atomic -lpthread
+//   ./bench_atm_atomic [사용자 수] [스레드당 건수]
+//
+// 모든 건이 같은 ATM 현금을 고치므로 어느 쪽이든 그 한 값이 경합 지점이다. 뮤텍스는
+// 경합하면 잠들고 깨우는 비용이 붙고, 원자 연산은 캐시 라인 하나만 오간다.
+// 끝나면 (잔액 합계 - ATM 현금) 이 처음과 같은지, 음수가 된 값이 없는지 확인한다.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "txn_reader.h"
+#include "txn_atomic.h"
+
+#define DEFAULT_USERS   1000
+#define DEFAULT_OPS     2000000
+#define MAX_THREADS     16
+#define START_BALANCE   100000
+#define START_CASH      5000000
+#define MAX_AMOUNT      1000
+
+// ---------- 상태 ----------
+
+typedef struct {
+    _Atomic int *balance;   // 1..users
+    _Atomic int cash;
+    pthread_mutex_t lock;   // 뮤텍스 방식에서만 쓴다
+    size_t users;
+} Bank;
+
+typedef struct {
+    Bank *bank;
+    int use_lock;
+    size_t ops;
+    unsigned id;
+    size_t failed;
+    pthread_barrier_t *start;
+} BenchArg;
+
+static inline uint64_t next_rand(uint64_t *s) {
+    uint64_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *s = x;
+}
+
+// ---------- 두 방식 ----------
+
+// 뮤텍스: 확인과 두 값 갱신을 한 임계 구역에서 한다
+static int atm_locked(Bank *b, int user, int amount) {
+    int ok = 1;
+    pthread_mutex_lock(&b->lock);
+    int bal = atomic_load_explicit(&b->balance[user], memory_order_relaxed);
+    int cash = atomic_load_explicit(&b->cash, memory_order_relaxed);
+    if (amount >= 0) {
+        bal += amount;
+        cash += amount;
+    } else if (-amount <= bal && -amount <= cash) {
+        bal += amount;
+        cash += amount;
+    } else {
+        ok = 0;
+    }
+    atomic_store_explicit(&b->balance[user], bal, memory_order_relaxed);
+    atomic_store_explicit(&b->cash, cash, memory_order_relaxed);
+    pthread_mutex_unlock(&b->lock);
+    return ok;
+}
+
+static int atm_atomic(Bank *b, int user, int amount) {
+    if (amount >= 0) {
+        txn_atm_deposit(&b->balance[user], &b->cash, amount);
+        return 1;
+    }
+    return txn_atm_withdraw(&b->balance[user], &b->cash, -amount) == TXN_ATM_OK;
+}
+
+static void *bench_worker(void *arg) {
+    BenchArg *a = arg;
+    Bank *b = a->bank;
+    uint64_t seed = 0x9e3779b97f4a7c15ULL ^ ((uint64_t)(a->id + 1) << 32);
+    size_t failed = 0;
+    pthread_barrier_wait(a->start);
+    for (size_t i = 0; i < a->ops; i++) {
+        uint64_t r = next_rand(&seed);
+        int user = (int)(r % b->users) + 1;
+        int amount = (int)((r >> 32) % MAX_AMOUNT) + 1;
+        if (r & (1ULL << 63))
+            amount = -amount;
+        failed += !(a->use_lock ? atm_locked(b, user, amount) : atm_atomic(b, user, amount));
+    }
+    a->failed = failed;
+    return NULL;
+}
+
+static void bench(const char *label, int use_lock, unsigned threads, size_t users, size_t ops) {
+    Bank b;
+    b.users = users;
+    b.balance = malloc((users + 1) * sizeof(*b.balance));
+    if (!b.balance) {
+        perror("계좌 배열 할당 실패");
+        exit(1);
+    }
+    for (size_t u = 0; u <= users; u++)
+        atomic_init(&b.balance[u], u ? START_BALANCE : 0);
+    atomic_init(&b.cash, START_CASH);
+    pthread_mutex_init(&b.lock, NULL);
+
+    pthread_barrier_t start;
+    pthread_barrier_init(&start, NULL, threads + 1);
+    BenchArg args[MAX_THREADS];
+    pthread_t tids[MAX_THREADS];
+    for (unsigned t = 0; t < threads; t++) {
+        args[t] = (BenchArg){&b, use_lock, ops, t, 0, &start};
+        pthread_create(&tids[t], NULL, bench_worker, &args[t]);
+    }
+    pthread_barrier_wait(&start);
+    unsigned long long t0 = txn_now_ns();
+    size_t failed = 0;
+    for (unsigned t = 0; t < threads; t++) {
+        pthread_join(tids[t], NULL);
+        failed += args[t].failed;
+    }
+    double sec = (txn_now_ns() - t0) / 1e9;
+    pthread_barrier_destroy(&start);
+
+    // 입출금은 계좌와 현금을 같이 움직이므로 (잔액 합계 - 현금) 은 변하지 않는다
+    long long sum = 0;
+    size_t negative = atomic_load(&b.cash) < 0;
+    for (size_t u = 1; u <= users; u++) {
+        int v = atomic_load(&b.balance[u]);
+        sum += v;
+        negative += v < 0;
+    }
+    long long drift = (sum - atomic_load(&b.cash)) - ((long long)users * START_BALANCE - START_CASH);
+
+    size_t total = ops * threads;
+    printf("스레드 %2u | %-4s | %8.2f M건/초 | %.6f 초 | 출금 실패 %.1f%%", threads, label,
+           total / sec / 1e6, sec, 100.0 * failed / total);
+    if (drift || negative)
+        printf(" | 불일치 %lld원, 음수 %zu개", drift, negative);
+    printf("\n");
+    pthread_mutex_destroy(&b.lock);
+    free(b.balance);
+}
+
+// ---------- 메인 ----------
+
+int main(int argc, char *argv[]) {
+    if (argc > 3) {
+        fprintf(stderr, "사용법: %s [사용자 수] [스레드당 건수]\n", argv[0]);
+        return 1;
+    }
+    size_t users = argc > 1 ? strtoull(argv[1], NULL, 10) : DEFAULT_USERS;
+    size_t ops = argc > 2 ? strtoull(argv[2], NULL, 10) : DEFAULT_OPS;
+    if (users == 0 || users > INT32_MAX || ops == 0) {
+        fprintf(stderr, "사용자 수는 1 ~ %d, 건수는 1 이상이어야 한다\n", INT32_MAX);
+        return 1;
+    }
+
+    printf("🏧 ATM 입출금: 사용자 %zu명 | 스레드당 %zu건 | CPU %ld개\n", users, ops,
+           sysconf(_SC_NPROCESSORS_ONLN));
+    for (unsigned threads = 1; threads <= MAX_THREADS; threads *= 2) {
+        bench("잠금", 1, threads, users, ops);
+        bench("원자", 0, threads, users, ops);
+    }
+    return 0;
+}
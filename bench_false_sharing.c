@@ -0,0 +1,178 @@
+// bench_false_sharing.c
+// d.c 처럼 사용자 번호 % 워커 수 로 일을 나눈 워커들이 계좌 잔액을 갱신할 때,
+// 번호 순서 배치(이웃 사용자가 한 캐시 라인)와 워커별 구간 배치(txn_partition.h)를 비교한다.
+// 워커 2 / 4 / 8 개에서 처리량과 캐시 미스(perf_event)를 잰다.
+//
+//   gcc -O2 bench_false_sharing.c -o bench_false_sharing -lpthread
+//   ./bench_false_sharing [사용자 수] [워커당 갱신 수]
+//
+// 기본 사용자 수는 테이블이 캐시에 들어가게 작게 잡아, 남는 미스가 거의 라인 공유에서 오게 한다.
+// 코어가 하나뿐이면 워커가 번갈아 돌 뿐이라 라인 공유 비용이 없고, 구간 배치의 주소 계산
+// (사용자 번호 → 구간/칸) 비용만 보인다. 차이는 워커 수만큼 코어가 있을 때 나타난다.
+// 캐시 미스 카운터를 못 여는 환경에서는 처리량만 출력한다.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "txn_reader.h"
+#include "txn_partition.h"
+
+#define DEFAULT_USERS   4096
+#define DEFAULT_UPDATES 5000000
+#define MAX_WORKERS     8
+
+// d.c 의 계좌와 같은 모양
+typedef struct {
+    int user;
+    int identifier;
+    int account;
+    int password;
+    int card_balance;
+} AccountInfo;
+
+// ---------- 캐시 미스 카운터 ----------
+
+// inherit: 켠 뒤에 만든 워커 스레드의 미스도 함께 센다
+static int open_miss_counter(void) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+// ---------- 작업 ----------
+
+typedef struct {
+    unsigned char *base;
+    const TxnPartition *pt;   // NULL 이면 번호 순서 배치
+    size_t users;
+    size_t updates;
+    unsigned worker, workers;
+    pthread_barrier_t *start;
+} BenchArg;
+
+static inline uint64_t next_rand(uint64_t *s) {
+    uint64_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *s = x;
+}
+
+static inline AccountInfo *bench_account(const BenchArg *a, int user) {
+    if (a->pt)
+        return txn_part_at(a->pt, a->base, user);
+    return (AccountInfo *)a->base + user;
+}
+
+// 자기 사용자(user % workers == worker) 중 무작위로 골라 1원씩 입금한다.
+// 잔액 쓰기가 배치 정보를 가릴 수 있다고 컴파일러가 보지 않도록 지역 복사본을 쓴다.
+static void *bench_worker(void *arg) {
+    BenchArg a = *(BenchArg *)arg;
+    TxnPartition pt;
+    if (a.pt) {
+        pt = *a.pt;
+        a.pt = &pt;
+    }
+    uint64_t seed = 0x9e3779b97f4a7c15ULL ^ ((uint64_t)(a.worker + 1) << 32);
+    size_t mine = (a.users - a.worker) / a.workers + 1;   // worker, worker + W, ... ≤ users
+    pthread_barrier_wait(a.start);
+    for (size_t i = 0; i < a.updates; i++) {
+        int user = (int)((next_rand(&seed) % mine) * a.workers + a.worker);
+        bench_account(&a, user)->card_balance += 1;
+    }
+    return NULL;
+}
+
+static void bench(const char *label, int partitioned, unsigned workers, size_t users,
+                  size_t updates, int counter) {
+    TxnPartition pt;
+    size_t bytes = partitioned ? txn_part_layout(&pt, users, workers, sizeof(AccountInfo))
+                               : (users + 1) * sizeof(AccountInfo);
+    bytes = (bytes + TXN_PART_LINE - 1) & ~(size_t)(TXN_PART_LINE - 1);   // aligned_alloc 조건
+    unsigned char *base = aligned_alloc(TXN_PART_LINE, bytes);
+    if (!base) {
+        perror("계좌 테이블 할당 실패");
+        exit(1);
+    }
+    memset(base, 0, bytes);
+
+    pthread_barrier_t start;
+    pthread_barrier_init(&start, NULL, workers + 1);
+    BenchArg args[MAX_WORKERS];
+    pthread_t tids[MAX_WORKERS];
+
+    long long misses = -1;
+    if (counter >= 0) {
+        ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+        ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    for (unsigned w = 0; w < workers; w++) {
+        args[w] = (BenchArg){base, partitioned ? &pt : NULL, users, updates, w, workers, &start};
+        pthread_create(&tids[w], NULL, bench_worker, &args[w]);
+    }
+    pthread_barrier_wait(&start);
+    unsigned long long t0 = txn_now_ns();
+    for (unsigned w = 0; w < workers; w++)
+        pthread_join(tids[w], NULL);
+    double sec = (txn_now_ns() - t0) / 1e9;
+    if (counter >= 0) {
+        ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(counter, &misses, sizeof(misses)) != (ssize_t)sizeof(misses))
+            misses = -1;
+    }
+    pthread_barrier_destroy(&start);
+
+    // 워커마다 자기 계좌만 쓰므로 갱신이 하나도 사라지지 않아야 한다
+    long long sum = 0;
+    for (size_t u = 0; u <= users; u++)
+        sum += bench_account(&args[0], (int)u)->card_balance;
+
+    size_t total = updates * workers;
+    printf("워커 %u | %-4s | %8.2f M건/초 | %.6f 초", workers, label, total / sec / 1e6, sec);
+    if (misses >= 0)
+        printf(" | 캐시 미스 %.4f/건", (double)misses / total);
+    if (sum != (long long)total)
+        printf(" | 합계 불일치 %lld != %zu", sum, total);
+    printf("\n");
+    free(base);
+}
+
+// ---------- 메인 ----------
+
+int main(int argc, char *argv[]) {
+    if (argc > 3) {
+        fprintf(stderr, "사용법: %s [사용자 수] [워커당 갱신 수]\n", argv[0]);
+        return 1;
+    }
+    size_t users = argc > 1 ? strtoull(argv[1], NULL, 10) : DEFAULT_USERS;
+    size_t updates = argc > 2 ? strtoull(argv[2], NULL, 10) : DEFAULT_UPDATES;
+    if (users < MAX_WORKERS || users > INT32_MAX || updates == 0) {
+        fprintf(stderr, "사용자 수는 %d ~ %d, 갱신 수는 1 이상이어야 한다\n", MAX_WORKERS, INT32_MAX);
+        return 1;
+    }
+
+    int counter = open_miss_counter();
+    printf("🧱 워커별 계좌 갱신: 사용자 %zu명 | 워커당 %zu건 | CPU %ld개%s\n", users, updates,
+           sysconf(_SC_NPROCESSORS_ONLN), counter < 0 ? " | 캐시 미스 카운터 사용 불가" : "");
+
+    for (unsigned workers = 2; workers <= MAX_WORKERS; workers *= 2) {
+        bench("번호", 0, workers, users, updates, counter);
+        bench("구간", 1, workers, users, updates, counter);
+    }
+
+    if (counter >= 0)
+        close(counter);
+    return 0;
+}
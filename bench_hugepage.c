@@ -0,0 +1,127 @@
+// bench_hugepage.c
+// 계좌 열 저장소를 4KB / THP / hugetlb 페이지로 잡아 무작위 사용자 접근 속도를 비교한다.
+// ATM 경로처럼 인증 열을 읽고 잔액 열을 바꾸며, 처리량과 dTLB 미스(perf_event)를 잰다.
+//
+//   gcc -O2 bench_hugepage.c -o bench_hugepage
+//   ./bench_hugepage [사용자 수] [접근 수]
+//
+// hugetlb 는 vm.nr_hugepages 로 페이지를 예약해 둬야 잡힌다. dTLB 카운터를 못 여는
+// 환경(가상 머신, perf_event_paranoid 등)에서는 처리량만 출력한다.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "txn_reader.h"
+#include "txn_accounts.h"
+
+#define DEFAULT_USERS    5000000
+#define DEFAULT_ACCESSES 20000000
+
+// ---------- dTLB 카운터 ----------
+
+static int open_dtlb_counter(void) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+// ---------- 작업 ----------
+
+static inline uint64_t next_rand(uint64_t *s) {
+    uint64_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *s = x;
+}
+
+// 균등 무작위 사용자 accesses 명에게 인증 후 1원 입금. 인증 실패 수를 돌려준다.
+static size_t run_random(TxnAccounts *acc, size_t accesses) {
+    uint64_t seed = 0x9e3779b97f4a7c15ULL;
+    size_t failed = 0;
+    for (size_t i = 0; i < accesses; i++) {
+        int user = (int)(next_rand(&seed) % acc->n) + 1;
+        if (!txn_accounts_auth(acc, user, user, user)) {
+            failed++;
+            continue;
+        }
+        acc->balance[user] += 1;
+    }
+    return failed;
+}
+
+static void bench(const char *mode, size_t users, size_t accesses, int counter) {
+    setenv(TXN_HUGE_ENV, mode, 1);
+    TxnAccounts acc;
+    if (txn_accounts_create(&acc, users) < 0) {
+        perror("계좌 저장소 할당 실패");
+        return;
+    }
+    for (size_t i = 1; i <= users; i++) {
+        acc.user[i] = (int)i;
+        acc.cred[i].account = (int)i;
+        acc.cred[i].password = (int)i;
+        acc.balance[i] = 10000000;
+    }
+
+    long long misses = -1;
+    if (counter >= 0) {
+        ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+        ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    unsigned long long t0 = txn_now_ns();
+    size_t failed = run_random(&acc, accesses);
+    double sec = (txn_now_ns() - t0) / 1e9;
+    if (counter >= 0) {
+        ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(counter, &misses, sizeof(misses)) != (ssize_t)sizeof(misses))
+            misses = -1;
+    }
+
+    printf("%-4s → %-7s | %.1f MB 중 2MB 페이지 %6.1f MB | %7.2f M건/초 | %.6f 초",
+           mode, txn_huge_name(acc.huge.kind), acc.bytes / (1024.0 * 1024.0),
+           txn_huge_backed(&acc.huge) / (1024.0 * 1024.0), accesses / sec / 1e6, sec);
+    if (misses >= 0)
+        printf(" | dTLB 미스 %.3f/건", (double)misses / accesses);
+    if (failed)
+        printf(" | 인증 실패 %zu", failed);
+    printf("\n");
+    txn_accounts_destroy(&acc);
+}
+
+// ---------- 메인 ----------
+
+int main(int argc, char *argv[]) {
+    if (argc > 3) {
+        fprintf(stderr, "사용법: %s [사용자 수] [접근 수]\n", argv[0]);
+        return 1;
+    }
+    size_t users = argc > 1 ? strtoull(argv[1], NULL, 10) : DEFAULT_USERS;
+    size_t accesses = argc > 2 ? strtoull(argv[2], NULL, 10) : DEFAULT_ACCESSES;
+    if (users == 0 || accesses == 0) {
+        fprintf(stderr, "사용자 수와 접근 수는 1 이상이어야 한다\n");
+        return 1;
+    }
+
+    int counter = open_dtlb_counter();
+    printf("🐘 무작위 사용자 접근: 사용자 %zu명 | 접근 %zu건%s\n", users, accesses,
+           counter < 0 ? " | dTLB 카운터 사용 불가" : "");
+
+    bench("off", users, accesses, counter);
+    bench("thp", users, accesses, counter);
+    bench("tlb", users, accesses, counter);
+
+    if (counter >= 0)
+        close(counter);
+    return 0;
+}
@@ -8,8 +8,10 @@
 #include <time.h>
 #include <math.h>
 #include <sys/resource.h>
+#include "txn_queues.h"
+#include "txn_users.h"
 
-#define MAX_USERS 1000
+#define DEFAULT_USERS 1000  // 실행 시 TXN_USERS 로 바꿀 수 있다
 #define SHM_NAME "/account_db_shm"
 
 typedef struct {
@@ -21,11 +23,13 @@ typedef struct {
 } AccountInfo;
 
 typedef struct {
-    AccountInfo accounts[MAX_USERS + 1];
     int bank_funds;
     int atm_funds;
+    AccountInfo accounts[];   // max_users + 1 칸 (세그먼트 끝에 붙는다)
 } AccountDB;
 
+size_t max_users;  // 실행 시 정한 사용자 수 (txn_users.h)
+
 volatile double dummy = 0.0;
 void sim_load() {
     for (int i = 0; i < 100000; i++) dummy += sqrt(i);
@@ -48,7 +52,7 @@ void print_cpu_time() {
 void init_account_db(AccountDB *db) {
     db->bank_funds = 500000;
     db->atm_funds = 1000000;
-    for (int i = 1; i <= MAX_USERS; i++) {
+    for (size_t i = 1; i <= max_users; i++) {
         db->accounts[i].user = i;
         db->accounts[i].identifier = i;
         db->accounts[i].account = i;
@@ -57,75 +61,81 @@ void init_account_db(AccountDB *db) {
     }
 }
 
-void handle_atm(FILE *fp, AccountDB *shared_db) {
-    int type, amount, user, account, password;
-    while (fscanf(fp, "%d", &type) == 1) {
-        if (type == 1) {
-            fscanf(fp, "%d %d %d %d", &amount, &user, &account, &password);
-            sim_load();
-            if (user < 1 || user > MAX_USERS) continue;
-            AccountInfo *info = &shared_db->accounts[user];
-            if (info->account != account || info->password != password) {
-                printf("ATM 인증 실패: 사용자 %d\n", user);
-                continue;
-            }
-            if (amount >= 0) {
-                info->card_balance += amount;
-                shared_db->atm_funds += amount;
-                printf("ATM 입금: 사용자 %d 금액 %d원\n", user, amount);
+void handle_atm(const TxnQueues *q, AccountDB *shared_db) {
+    size_t n;
+    const TxnRecord *recs = txn_queue(q, TXN_ATM, &n);
+    for (size_t i = 0; i < n; i++) {
+        TxnRecord rec = recs[i];
+        int amount = rec.amount, user = rec.user, account = rec.account, password = rec.password;
+        sim_load();
+        if (!txn_user_valid(user, max_users)) continue;
+        AccountInfo *info = &shared_db->accounts[user];
+        if (info->account != account || info->password != password) {
+            printf("ATM 인증 실패: 사용자 %d\n", user);
+            continue;
+        }
+        if (amount >= 0) {
+            info->card_balance += amount;
+            shared_db->atm_funds += amount;
+            printf("ATM 입금: 사용자 %d 금액 %d원\n", user, amount);
+        } else {
+            int withdraw = -amount;
+            if (withdraw <= info->card_balance && withdraw <= shared_db->atm_funds) {
+                info->card_balance -= withdraw;
+                shared_db->atm_funds -= withdraw;
+                printf("ATM 출금: 사용자 %d 금액 %d원\n", user, withdraw);
             } else {
-                int withdraw = -amount;
-                if (withdraw <= info->card_balance && withdraw <= shared_db->atm_funds) {
-                    info->card_balance -= withdraw;
-                    shared_db->atm_funds -= withdraw;
-                    printf("ATM 출금: 사용자 %d 금액 %d원\n", user, withdraw);
-                } else {
-                    printf("ATM 출금 실패: 사용자 %d 잔액 부족\n", user);
-                }
+                printf("ATM 출금 실패: 사용자 %d 잔액 부족\n", user);
             }
-        } else {
-            continue; // 잘못된 type이면 무시
         }
     }
 }
 
-void handle_mobile(FILE *fp, AccountDB *shared_db) {
-    int type, amount, sender, account, password, receiver;
-    while (fscanf(fp, "%d", &type) == 1) {
-        if (type == 3) {
-            fscanf(fp, "%d %d %d %d %d", &amount, &sender, &account, &password, &receiver);
-            sim_load();
-            if (sender < 1 || sender > MAX_USERS || receiver < 1 || receiver > MAX_USERS) continue;
-            AccountInfo *s = &shared_db->accounts[sender];
-            AccountInfo *r = &shared_db->accounts[receiver];
-            if (s->account != account || s->password != password) {
-                printf("송금 실패: 계좌번호 또는 비밀번호 불일치 (송금자 %d번)\n\n", sender);
-                continue;
-            }
-            if (s->card_balance < amount) {
-                printf("송금 실패: 잔액 부족 (송금자 %d번, 필요: %d, 보유: %d)\n\n",
-                       sender, amount, s->card_balance);
-                continue;
-            }
-            s->card_balance -= amount;
-            r->card_balance += amount;
-            printf("송금 성공: %d번 → %d번, 금액: %d\n", sender, receiver, amount);
-            printf("송금자 남은 잔액: %d\n", s->card_balance);
-            printf("수신자 새로운 잔액: %d\n\n", r->card_balance);
-        } else {
-            continue; // 잘못된 type이면 무시
+void handle_mobile(const TxnQueues *q, AccountDB *shared_db) {
+    size_t n;
+    const TxnRecord *recs = txn_queue(q, TXN_TRANSFER, &n);
+    for (size_t i = 0; i < n; i++) {
+        TxnRecord rec = recs[i];
+        int amount = rec.amount, sender = rec.user, account = rec.account,
+            password = rec.password, receiver = rec.receiver;
+        sim_load();
+        if (!txn_user_valid(sender, max_users) || !txn_user_valid(receiver, max_users)) continue;
+        AccountInfo *s = &shared_db->accounts[sender];
+        AccountInfo *r = &shared_db->accounts[receiver];
+        if (s->account != account || s->password != password) {
+            printf("송금 실패: 계좌번호 또는 비밀번호 불일치 (송금자 %d번)\n\n", sender);
+            continue;
+        }
+        if (s->card_balance < amount) {
+            printf("송금 실패: 잔액 부족 (송금자 %d번, 필요: %d, 보유: %d)\n\n",
+                   sender, amount, s->card_balance);
+            continue;
         }
+        s->card_balance -= amount;
+        r->card_balance += amount;
+        printf("송금 성공: %d번 → %d번, 금액: %d\n", sender, receiver, amount);
+        printf("송금자 남은 잔액: %d\n", s->card_balance);
+        printf("수신자 새로운 잔액: %d\n\n", r->card_balance);
     }
 }
 
 int main(int argc, char *argv[]) {
     if (argc != 2) {
-        fprintf(stderr, "사용법: %s <입력파일>\n", argv[0]);
+        fprintf(stderr, "사용법: %s <입력파일|->\n", argv[0]);
         return 1;
     }
+    max_users = txn_users_count(DEFAULT_USERS);
     struct timespec start_time, end_time;
     clock_gettime(CLOCK_MONOTONIC, &start_time);
     
+    // 부모는 ATM/송금 줄만 색인으로 골라 파싱하고, ATM 자식은 그 매핑을 상속한다.
+    // exec 된 대출 자식은 세그먼트에 대출이 없으므로 색인으로 대출 줄만 따로 파싱한다.
+    TxnQueues *q = txn_queues_build_types(argv[1], (1u << TXN_ATM) | (1u << TXN_TRANSFER));
+    if (!q) {
+        perror("파일 열기 실패");
+        return 1;
+    }
+
     pid_t loan_pid = fork();
     if (loan_pid == 0) {
         execl("./c_1_child", "c_1_child", argv[1], NULL);
@@ -134,23 +144,20 @@ int main(int argc, char *argv[]) {
     }
 
     int shm_fd = shm_open(SHM_NAME, O_CREAT | O_RDWR, 0666);
-    ftruncate(shm_fd, sizeof(AccountDB));
-    AccountDB *shared_db = mmap(NULL, sizeof(AccountDB), PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+    // 헤더 뒤에 사용자 max_users + 1 명 분의 배열이 붙는다
+    size_t db_bytes = sizeof(AccountDB) + txn_users_bytes(sizeof(AccountInfo), max_users);
+    txn_users_report("공유 계좌 테이블", max_users, sizeof(AccountInfo));
+    ftruncate(shm_fd, db_bytes);
+    AccountDB *shared_db = mmap(NULL, db_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
     init_account_db(shared_db);
 
     pid_t atm_pid = fork();
     if (atm_pid == 0) {
-        FILE *fp = fopen(argv[1], "r");
-        if (!fp) exit(1);
-        handle_atm(fp, shared_db);
-        fclose(fp);
+        handle_atm(q, shared_db);
         exit(0);
     }
 
-    FILE *fp = fopen(argv[1], "r");
-    if (!fp) exit(1);
-    handle_mobile(fp, shared_db);
-    fclose(fp);
+    handle_mobile(q, shared_db);
 
     wait(NULL); wait(NULL); wait(NULL);
     clock_gettime(CLOCK_MONOTONIC, &end_time);
@@ -160,6 +167,7 @@ int main(int argc, char *argv[]) {
     print_cpu_time();
     printf("⏱ 전체 실행 시간 (Wall-clock): %.6f 초\n\n", wall_sec);
     shm_unlink(SHM_NAME);
+    txn_queues_release(q);
     return 0;
 }
 
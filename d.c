@@ -9,9 +9,15 @@
 #include <math.h>
 #include <sys/resource.h>
 #include <pthread.h>
+#include "txn_queues.h"
+#include "txn_users.h"
+#include "txn_partition.h"
+#include "txn_locks.h"
+#include "txn_dispatch.h"
 
-#define MAX_USERS 1000
+#define DEFAULT_USERS 1000  // 실행 시 TXN_USERS 로 바꿀 수 있다
 #define SHM_NAME "/account_db_shm"
+#define DEFAULT_WORKERS 2   // 프로세스당 스레드 수 (--workers N). 사용자 번호 % 워커 수로 나눈다
 
 typedef struct {
     int user;
@@ -21,12 +27,31 @@ typedef struct {
     int card_balance;
 } AccountInfo;
 
+// 전역 값은 각자 캐시 라인을 차지하고, 계좌는 워커별 연속 구간에 둔다 (txn_partition.h).
+// 그래서 한 워커의 계좌 갱신이 다른 워커의 계좌나 ATM 자금이 든 라인을 무효화하지 않는다.
+// 계좌 구간 뒤에는 사용자별 줄무늬 잠금 표가 붙는다 (locks_of). 송금 수신자는 다른 워커,
+// 다른 프로세스의 계좌일 수 있으므로 계좌를 고칠 때는 그 줄무늬를 잡는다.
+// 잠금 순서: 사용자 줄무늬 → ATM 자금 잠금 (txn_locks.h)
 typedef struct {
-    AccountInfo accounts[MAX_USERS + 1];
-    int bank_funds;
-    int atm_funds;
+    _Alignas(TXN_PART_LINE) int bank_funds;
+    TxnLock atm_lock;
+    _Alignas(TXN_PART_LINE) int atm_funds;
+    _Alignas(TXN_PART_LINE) unsigned char accounts[];   // 워커별 구간 (account_of 로 접근)
 } AccountDB;
 
+size_t max_users;  // 실행 시 정한 사용자 수 (txn_users.h)
+unsigned num_workers;  // 실행 시 정한 워커 수 (txn_workers.h)
+TxnPartition acc_part;
+size_t locks_off;   // 세그먼트에서 잠금 표의 위치
+
+static inline AccountInfo *account_of(AccountDB *db, int user) {
+    return txn_part_at(&acc_part, db->accounts, user);
+}
+
+static inline TxnLocks *locks_of(AccountDB *db) {
+    return (TxnLocks *)((char *)db + locks_off);
+}
+
 volatile double dummy = 0.0;
 void sim_load() {
     for (int i = 0; i < 100000; i++) dummy += sqrt(i);
@@ -45,137 +70,176 @@ void print_cpu_time() {
 }  
 
 void init_account_db(AccountDB *db) {
+    if (txn_lock_init(&db->atm_lock) < 0 ||
+        txn_locks_init(locks_of(db), txn_locks_stripes(max_users)) < 0) {
+        perror("잠금 초기화 실패");
+        exit(1);
+    }
     db->bank_funds = 500000;
     db->atm_funds = 1000000;
-    for (int i = 1; i <= MAX_USERS; i++) {
-        db->accounts[i].user = i;
-        db->accounts[i].identifier = i;
-        db->accounts[i].account = i;
-        db->accounts[i].password = i;
-        db->accounts[i].card_balance = 100000;
+    for (size_t i = 1; i <= max_users; i++) {
+        AccountInfo *info = account_of(db, (int)i);
+        info->user = i;
+        info->identifier = i;
+        info->account = i;
+        info->password = i;
+        info->card_balance = 100000;
     }
 }
 
 typedef struct {
-    FILE *fp;
+    const TxnRecord *recs;  // 부모가 워커별로 나눠 둔 이 워커의 몫 (fork 로 상속)
+    size_t n;
     AccountDB *db;
-    int parity; // 0: even, 1: odd
 } ThreadArg;
 
 void *handle_atm_thread(void *arg) {
     ThreadArg *targ = (ThreadArg *)arg;
-    int type, amount, user, account, password;
-    rewind(targ->fp);
-    while (fscanf(targ->fp, "%d", &type) == 1) {
-        if (type == 1) {
-            fscanf(targ->fp, "%d %d %d %d", &amount, &user, &account, &password);
-            if (user % 2 != targ->parity) continue;
-            sim_load();
-            if (user < 1 || user > MAX_USERS) continue;
-            AccountInfo *info = &targ->db->accounts[user];
-            if (info->account != account || info->password != password) {
-                printf("ATM 인증 실패: 사용자 %d\n", user);
-                continue;
-            }
-            if (amount >= 0) {
-                info->card_balance += amount;
-                targ->db->atm_funds += amount;
-                printf("ATM 입금: 사용자 %d 금액 %d원\n", user, amount);
-            } else {
-                int withdraw = -amount;
-                if (withdraw <= info->card_balance && withdraw <= targ->db->atm_funds) {
-                    info->card_balance -= withdraw;
-                    targ->db->atm_funds -= withdraw;
-                    printf("ATM 출금: 사용자 %d 금액 %d원\n", user, withdraw);
-                } else {
-                    printf("ATM 출금 실패: 사용자 %d 잔액 부족\n", user);
-                }
-            }
+    for (size_t i = 0; i < targ->n; i++) {
+        TxnRecord rec = targ->recs[i];
+        int amount = rec.amount, user = rec.user, account = rec.account, password = rec.password;
+        sim_load();
+        if (!txn_user_valid(user, max_users)) continue;
+        AccountInfo *info = account_of(targ->db, user);
+        if (info->account != account || info->password != password) {
+            printf("ATM 인증 실패: 사용자 %d\n", user);
+            continue;
+        }
+        int withdraw = -amount, ok = 1;
+        TxnLock *l = txn_locks_for(locks_of(targ->db), user);
+        txn_lock(l);
+        txn_lock(&targ->db->atm_lock);
+        if (amount >= 0) {
+            info->card_balance += amount;
+            targ->db->atm_funds += amount;
+        } else if (withdraw <= info->card_balance && withdraw <= targ->db->atm_funds) {
+            info->card_balance -= withdraw;
+            targ->db->atm_funds -= withdraw;
         } else {
-            fscanf(targ->fp, "%*[^\"\n]"); fscanf(targ->fp, "%*c"); // skip line
+            ok = 0;
         }
+        txn_unlock(&targ->db->atm_lock);
+        txn_unlock(l);
+
+        if (amount >= 0)
+            printf("ATM 입금: 사용자 %d 금액 %d원\n", user, amount);
+        else if (ok)
+            printf("ATM 출금: 사용자 %d 금액 %d원\n", user, withdraw);
+        else
+            printf("ATM 출금 실패: 사용자 %d 잔액 부족\n", user);
     }
     return NULL;
 }
 
 void *handle_mobile_thread(void *arg) {
     ThreadArg *targ = (ThreadArg *)arg;
-    int type, amount, sender, account, password, receiver;
-    rewind(targ->fp);
-    while (fscanf(targ->fp, "%d", &type) == 1) {
-        if (type == 3) {
-            fscanf(targ->fp, "%d %d %d %d %d", &amount, &sender, &account, &password, &receiver);
-            if (sender % 2 != targ->parity) continue;
-            sim_load();
-            if (sender < 1 || sender > MAX_USERS || receiver < 1 || receiver > MAX_USERS) continue;
-            AccountInfo *s = &targ->db->accounts[sender];
-            AccountInfo *r = &targ->db->accounts[receiver];
-            if (s->account != account || s->password != password) {
-                printf("송금 실패: 계좌번호 또는 비밀번호 불일치 (송금자 %d번)\n\n", sender);
-                continue;
-            }
-            if (s->card_balance < amount) {
-                printf("송금 실패: 잔액 부족 (송금자 %d번, 필요: %d, 보유: %d)\n\n",
-                       sender, amount, s->card_balance);
-                continue;
-            }
+    for (size_t i = 0; i < targ->n; i++) {
+        TxnRecord rec = targ->recs[i];
+        int amount = rec.amount, sender = rec.user, account = rec.account,
+            password = rec.password, receiver = rec.receiver;
+        sim_load();
+        if (!txn_user_valid(sender, max_users) || !txn_user_valid(receiver, max_users)) continue;
+        AccountInfo *s = account_of(targ->db, sender);
+        AccountInfo *r = account_of(targ->db, receiver);
+        if (s->account != account || s->password != password) {
+            printf("송금 실패: 계좌번호 또는 비밀번호 불일치 (송금자 %d번)\n\n", sender);
+            continue;
+        }
+        TxnLock *held[2];
+        txn_locks_lock_pair(locks_of(targ->db), sender, receiver, held);
+        int have = s->card_balance;
+        if (have >= amount) {
             s->card_balance -= amount;
             r->card_balance += amount;
-            printf("송금 성공: %d번 → %d번, 금액: %d\n", sender, receiver, amount);
-            printf("송금자 남은 잔액: %d\n", s->card_balance);
-            printf("수신자 새로운 잔액: %d\n\n", r->card_balance);
-        } else {
-            fscanf(targ->fp, "%*[^\"\n]"); fscanf(targ->fp, "%*c"); // skip line
         }
+        int s_after = s->card_balance, r_after = r->card_balance;
+        txn_locks_unlock_pair(held);
+
+        if (have < amount) {
+            printf("송금 실패: 잔액 부족 (송금자 %d번, 필요: %d, 보유: %d)\n\n",
+                   sender, amount, have);
+            continue;
+        }
+        printf("송금 성공: %d번 → %d번, 금액: %d\n", sender, receiver, amount);
+        printf("송금자 남은 잔액: %d\n", s_after);
+        printf("수신자 새로운 잔액: %d\n\n", r_after);
     }
     return NULL;
 }
 
+// 워커 num_workers 개를 띄워 각자 자기 몫(자기 구간의 사용자)만 처리하게 한다
+void run_workers(const TxnBuckets *b, AccountDB *db, void *(*fn)(void *)) {
+    pthread_t tids[TXN_WORKERS_MAX];
+    ThreadArg args[TXN_WORKERS_MAX];
+    for (unsigned w = 0; w < num_workers; w++) {
+        args[w].recs = txn_bucket(b, w, &args[w].n);
+        args[w].db = db;
+        pthread_create(&tids[w], NULL, fn, &args[w]);
+    }
+    for (unsigned w = 0; w < num_workers; w++)
+        pthread_join(tids[w], NULL);
+}
+
 int main(int argc, char *argv[]) {
-    if (argc != 2) {
-        fprintf(stderr, "사용법: %s <입력파일>\n", argv[0]);
+    // --workers N 을 줬을 때만 exec 하는 대출 처리기(m_c)도 같은 값을 쓴다. 아니면 m_c 기본값
+    num_workers = txn_workers_arg(&argc, argv, DEFAULT_WORKERS);
+    if (argc != 2 || !num_workers) {
+        fprintf(stderr, "사용법: %s [--workers N] <입력파일|->\n", argv[0]);
         return 1;
     }
+    max_users = txn_users_count(DEFAULT_USERS);
     struct timespec start_time, end_time;
     clock_gettime(CLOCK_MONOTONIC, &start_time);
 
+    // 입력은 한 번만 파싱한다. fork 된 ATM/송금 프로세스는 매핑을 상속하고
+    // exec 된 대출 프로세스는 TXN_QUEUES_FD 로 같은 세그먼트를 붙인다.
+    TxnQueues *q = txn_queues_build(argv[1]);
+    if (!q) {
+        perror("파일 열기 실패");
+        return 1;
+    }
+
+    // ATM 과 송금을 워커별 몫으로 한 번씩만 나눈다. 워커가 전체 배열을 훑지 않는다.
+    TxnBuckets atm_work, tr_work;
+    size_t atm_n, tr_n;
+    const TxnRecord *atm_recs = txn_queue(q, TXN_ATM, &atm_n);
+    const TxnRecord *tr_recs = txn_queue(q, TXN_TRANSFER, &tr_n);
+    if (txn_buckets_build(&atm_work, &atm_recs, &atm_n, 1, num_workers) < 0 ||
+        txn_buckets_build(&tr_work, &tr_recs, &tr_n, 1, num_workers) < 0) {
+        perror("작업 나누기 실패");
+        return 1;
+    }
+    txn_buckets_report(&atm_work, "ATM");
+    txn_buckets_report(&tr_work, "송금");
+
     int shm_fd = shm_open(SHM_NAME, O_CREAT | O_RDWR, 0666);
-    ftruncate(shm_fd, sizeof(AccountDB));
-    AccountDB *shared_db = mmap(NULL, sizeof(AccountDB), PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+    // 헤더 뒤에 워커별 계좌 구간, 그 뒤 캐시 라인 경계에 잠금 표가 붙는다
+    locks_off = sizeof(AccountDB) +
+                txn_part_layout(&acc_part, max_users, num_workers, sizeof(AccountInfo));
+    locks_off = (locks_off + TXN_LOCK_LINE - 1) & ~(size_t)(TXN_LOCK_LINE - 1);
+    size_t db_bytes = locks_off + txn_locks_bytes(txn_locks_stripes(max_users));
+    txn_users_report("공유 계좌 테이블", max_users, sizeof(AccountInfo));
+    txn_part_report(&acc_part, "공유 계좌");
+    ftruncate(shm_fd, db_bytes);
+    AccountDB *shared_db = mmap(NULL, db_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
     init_account_db(shared_db);
+    txn_locks_report(locks_of(shared_db), "공유 계좌");
 
     pid_t atm_pid = fork();
     if (atm_pid == 0) {
-        FILE *fp = fopen(argv[1], "r");
-        if (!fp) exit(1);
-        pthread_t t1, t2;
-        ThreadArg arg1 = {fp, shared_db, 0};
-        ThreadArg arg2 = {fp, shared_db, 1};
-        pthread_create(&t1, NULL, handle_atm_thread, &arg1);
-        pthread_create(&t2, NULL, handle_atm_thread, &arg2);
-        pthread_join(t1, NULL);
-        pthread_join(t2, NULL);
-        fclose(fp);
+        run_workers(&atm_work, shared_db, handle_atm_thread);
         exit(0);
     }
 
     pid_t transfer_pid = fork();
     if (transfer_pid == 0) {
-        FILE *fp = fopen(argv[1], "r");
-        if (!fp) exit(1);
-        pthread_t t1, t2;
-        ThreadArg arg1 = {fp, shared_db, 0};
-        ThreadArg arg2 = {fp, shared_db, 1};
-        pthread_create(&t1, NULL, handle_mobile_thread, &arg1);
-        pthread_create(&t2, NULL, handle_mobile_thread, &arg2);
-        pthread_join(t1, NULL);
-        pthread_join(t2, NULL);
-        fclose(fp);
+        run_workers(&tr_work, shared_db, handle_mobile_thread);
         exit(0);
     }
 
     pid_t loan_pid = fork();
     if (loan_pid == 0) {
+        txn_queues_share(q);   // 대출 자식만 세그먼트를 물려받는다
         execl("./m_c", "m_c", argv[1], NULL);
         perror("exec 실패");
         exit(1);
@@ -186,8 +250,16 @@ int main(int argc, char *argv[]) {
     double wall_sec = (end_time.tv_sec - start_time.tv_sec)
                     + (end_time.tv_nsec - start_time.tv_nsec) / 1e9;
 
+    TxnLockStats st = txn_locks_stats(locks_of(shared_db));
+    txn_lock_stats_report(&st, "계좌 줄무늬");
+    TxnLockStats funds = {0, 0, 0};
+    txn_lock_stats_add(&funds, &shared_db->atm_lock);
+    txn_lock_stats_report(&funds, "ATM 자금");
     print_cpu_time();
     printf("\u23F1 전체 실행 시간 (Wall-clock): %.6f 초\n\n", wall_sec);
     shm_unlink(SHM_NAME);
+    txn_queues_release(q);
+    txn_buckets_free(&atm_work);
+    txn_buckets_free(&tr_work);
     return 0;
 }
@@ -7,10 +7,12 @@
 #include <string.h>
 #include <sys/resource.h>
 #include <time.h>
+#include "txn_queues.h"
+#include "txn_users.h"
+#include "txn_dispatch.h"
 
-#define MAX_USERS 1000
-#define MAX_REQUESTS 10000
-#define THREAD_COUNT 1  // 여기서 2, 3, 4로 변경하며 실험
+#define DEFAULT_USERS 1000  // 실행 시 TXN_USERS 로 바꿀 수 있다
+#define DEFAULT_WORKERS 1  // --workers N (또는 TXN_WORKERS) 으로 2, 3, 4 로 바꾸며 실험
 
 typedef struct {
     int user;
@@ -20,17 +22,24 @@ typedef struct {
 } UserInfo;
 
 typedef struct {
-    UserInfo users[MAX_USERS + 1];
+    UserInfo *users;   // max_users + 1 칸 (txn_users_table)
     int bank_funds;
     pthread_mutex_t lock;
 } UserDB;
 
+size_t max_users;  // 실행 시 정한 사용자 수 (txn_users.h)
 UserDB user_db;
 
 void init_user_db() {
     user_db.bank_funds = 500000;
     pthread_mutex_init(&user_db.lock, NULL);
-    for (int i = 1; i <= MAX_USERS; i++) {
+    user_db.users = txn_users_table(sizeof(UserInfo), max_users);
+    if (!user_db.users) {
+        perror("사용자 테이블 할당 실패");
+        exit(1);
+    }
+    txn_users_report("사용자 테이블", max_users, sizeof(UserInfo));
+    for (size_t i = 1; i <= max_users; i++) {
         user_db.users[i].user = i;
         user_db.users[i].identifier = i;
         user_db.users[i].debt = 0;
@@ -101,26 +110,25 @@ int get_limit_by_credit_rank(int rank) {
     }
 }
 
+// 스레드별 요청 목록 (user % 워커 수 로 나눈 연속 배열, txn_dispatch.h)
 typedef struct {
-    int amount, name, identifier;
-} LoanRequest;
-
-LoanRequest requests[MAX_REQUESTS];
-int request_count = 0;
-
-typedef struct {
-    int start, end;
-} ThreadArg;
+    const TxnRecord *recs;
+    size_t n;
+} LoanShare;
 
 void* loan_worker(void *arg) {
-    ThreadArg *range = (ThreadArg *)arg;
-    for (int i = range->start; i < range->end; i++) {
-        LoanRequest *r = &requests[i];
+    LoanShare *share = arg;
+    for (size_t i = 0; i < share->n; i++) {
+        const TxnRecord *r = &share->recs[i];
         loan_sim_load();
 
-        UserInfo *user = &user_db.users[r->name];
-        if (user->identifier != r->identifier) {
-            fprintf(stderr, "[상담원] 인증 실패: 사용자 %d\n", r->name);
+        if (!txn_user_valid(r->user, max_users)) {
+            fprintf(stderr, "[상담원] 대출 거절: 잘못된 사용자 번호 %d\n", r->user);
+            continue;
+        }
+        UserInfo *user = &user_db.users[r->user];
+        if (user->identifier != txn_identifier(r)) {
+            fprintf(stderr, "[상담원] 인증 실패: 사용자 %d\n", r->user);
             continue;
         }
 
@@ -137,7 +145,7 @@ void* loan_worker(void *arg) {
             user_db.bank_funds -= r->amount;
             fprintf(stderr,
                     "[상담원] 대출 승인: 사용자 %d | 금액: %d | 부채: %d | 남은 은행 자금: %d\n",
-                    r->name, r->amount, user->debt, user_db.bank_funds);
+                    r->user, r->amount, user->debt, user_db.bank_funds);
         }
         pthread_mutex_unlock(&user_db.lock);
     }
@@ -145,46 +153,49 @@ void* loan_worker(void *arg) {
 }
 
 int main(int argc, char *argv[]) {
-    if (argc != 2) {
-        fprintf(stderr, "사용법: %s <입력파일>\n", argv[0]);
+    // 부모가 --workers N 을 받았으면 TXN_WORKERS 로 넘어온다. 아니면 DEFAULT_WORKERS
+    unsigned num_workers = txn_workers_arg(&argc, argv, DEFAULT_WORKERS);
+    if (argc != 2 || !num_workers) {
+        fprintf(stderr, "사용법: %s [--workers N] <입력파일|->\n", argv[0]);
         return 1;
     }
+    max_users = txn_users_count(DEFAULT_USERS);
 
     struct timespec start_time, end_time;
     clock_gettime(CLOCK_MONOTONIC, &start_time);
 
-    FILE *fp = fopen(argv[1], "r");
-    if (!fp) {
+    // 부모가 넘긴 대출 배열을 그대로 쓴다 (없으면 색인으로 대출 줄만 파싱)
+    TxnQueues *q = txn_queues_load(argv[1], 1u << TXN_LOAN);
+    if (!q) {
         perror("파일 열기 실패");
         return 1;
     }
 
     init_user_db();
-    int type, amount, name, identifier, dummy;
-    while (fscanf(fp, "%d", &type) == 1) {
-        if (type == 2) {
-            fscanf(fp, "%d %d %d %d", &amount, &name, &identifier, &dummy);
-            requests[request_count++] = (LoanRequest){amount, name, identifier};
-        } else {
-            fscanf(fp, "%*[^\n]"); fscanf(fp, "%*c");
-        }
+    size_t loan_n;
+    const TxnRecord *loans = txn_queue(q, TXN_LOAN, &loan_n);
+    // 같은 사용자의 대출은 한 스레드가 입력 순서대로 처리한다
+    TxnBuckets work;
+    if (txn_buckets_build(&work, &loans, &loan_n, 1, num_workers) < 0) {
+        perror("요청 나누기 실패");
+        return 1;
     }
-    fclose(fp);
-
-    pthread_t threads[THREAD_COUNT];
-    ThreadArg args[THREAD_COUNT];
-    int chunk = (request_count + THREAD_COUNT - 1) / THREAD_COUNT;
-
-    for (int i = 0; i < THREAD_COUNT; i++) {
-        args[i].start = i * chunk;
-        args[i].end = (i + 1) * chunk;
-        if (args[i].end > request_count) args[i].end = request_count;
-        pthread_create(&threads[i], NULL, loan_worker, &args[i]);
+    txn_queues_release(q);
+    txn_buckets_report(&work, "대출");
+
+    pthread_t threads[TXN_WORKERS_MAX];
+    LoanShare shares[TXN_WORKERS_MAX];
+    for (unsigned i = 0; i < num_workers; i++) {
+        shares[i].recs = txn_bucket(&work, i, &shares[i].n);
+        pthread_create(&threads[i], NULL, loan_worker, &shares[i]);
     }
-    for (int i = 0; i < THREAD_COUNT; i++) {
-        print_memory_usage("👶 자식 프로세스 (대출) %d", i);
+    for (unsigned i = 0; i < num_workers; i++) {
+        char label[64];
+        snprintf(label, sizeof(label), "👶 자식 프로세스 (대출) %u", i);
+        print_memory_usage(label);
         pthread_join(threads[i], NULL);
     }
+    txn_buckets_free(&work);
 
     clock_gettime(CLOCK_MONOTONIC, &end_time);
     double wall_sec = (end_time.tv_sec - start_time.tv_sec)
@@ -2,19 +2,24 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
-#include <fcntl.h>
 #include <sys/mman.h>
 #include <sys/wait.h>
 #include <string.h>
 #include <math.h>
 #include <sys/resource.h>
+#include "txn_stream.h"
+#include "txn_users.h"
+#include "txn_bank.h"
+#include "txn_dispatch.h"
 
-#define MAX_USERS 1000
-#define MAX_LOANS 10000
-#define SHM_NAME "/user_db_shm"
+#define DEFAULT_USERS 1000  // 실행 시 TXN_USERS 로 바꿀 수 있다
+#define DEFAULT_WORKERS 2   // 대출 처리 프로세스 수, --workers N 이나 TXN_WORKERS 로 바꿀 수 있다
 
 
 //연산용
+size_t max_users;  // 실행 시 정한 사용자 수 (txn_users.h)
+unsigned num_workers;  // 실행 시 정한 워커 수 (txn_workers.h)
+
 volatile double dummy = 0.0;
 void sim_load() {
     for (int i = 0; i < 100000; i++) dummy += sqrt(i);
@@ -35,6 +40,24 @@ void print_cpu_time() {
     printf("  🕒 총합: %.6f 초\n\n", user_sec + sys_sec);
 }  
 
+// 공유 데이터베이스: 계좌 DB 와 대출 DB 가 세그먼트 하나에 있다 (txn_bank.h).
+// 실행기(multipar.c)와 같은 구조체여야 한다. 크기가 다르면 붙지 않는다.
+typedef struct {
+    int user;
+    int identifier;
+    int account;
+    int password;
+    int card_balance;
+} AccountInfo;
+
+// 계좌 칸과 사용자 칸은 세그먼트의 줄무늬 잠금(txn_bank_locks)이, 전역 자금은 옆의 잠금이 지킨다.
+// 잠금 순서: 사용자 줄무늬 → ATM/은행 자금 잠금 (txn_locks.h)
+typedef struct {
+    TxnLock atm_lock;
+    int atm_funds;
+    _Alignas(TXN_BANK_LINE) AccountInfo accounts[];   // max_users + 1 칸
+} AccountDB;
+
 // 사용자 정보
 typedef struct {
     int user;
@@ -43,12 +66,15 @@ typedef struct {
     int credit_rank;
 } UserInfo;
 
-// 공유 데이터베이스
 typedef struct {
-    UserInfo users[MAX_USERS + 1];
+    TxnLock bank_lock;
     int bank_funds;
+    _Alignas(TXN_BANK_LINE) UserInfo users[];   // max_users + 1 칸
 } UserDB;
 
+static const TxnBankShape bank_shape = {sizeof(AccountDB), sizeof(AccountInfo),
+                                        sizeof(UserDB), sizeof(UserInfo)};
+
 // 대출 요청 구조체
 typedef struct {
     int amount;
@@ -57,13 +83,29 @@ typedef struct {
     int dummy_val;
 } LoanReq;
 
-LoanReq loan_reqs[MAX_LOANS];
-int loan_count = 0;
+// DB 초기화 (단독 실행일 때만. 보통은 실행기가 채운 세그먼트를 붙인다)
+void init_account_db(AccountDB *db) {
+    if (txn_lock_init(&db->atm_lock) < 0) {
+        perror("ATM 자금 잠금 초기화 실패");
+        exit(1);
+    }
+    db->atm_funds = 1000000;
+    for (size_t i = 1; i <= max_users; i++) {
+        db->accounts[i].user = i;
+        db->accounts[i].identifier = i;
+        db->accounts[i].account = i;
+        db->accounts[i].password = i;
+        db->accounts[i].card_balance = 100000;
+    }
+}
 
-// DB 초기화
 void init_user_db(UserDB *db) {
+    if (txn_lock_init(&db->bank_lock) < 0) {
+        perror("은행 자금 잠금 초기화 실패");
+        exit(1);
+    }
     db->bank_funds = 500000;
-    for (int i = 1; i <= MAX_USERS; i++) {
+    for (size_t i = 1; i <= max_users; i++) {
         db->users[i].user = i;
         db->users[i].identifier = i;
         db->users[i].debt = 0;
@@ -71,90 +113,172 @@ void init_user_db(UserDB *db) {
     }
 }
 
-// 단일 대출 요청 처리
-void handle_single_loan(LoanReq *req, UserDB *shared_db) {
+// 단일 대출 요청 처리: 승인된 대출금은 같은 세그먼트의 카드 잔액으로 바로 들어간다
+void handle_single_loan(LoanReq *req, TxnBank *bank) {
     sim_load();
-    if (req->user < 1 || req->user > MAX_USERS) return;
+    if (!txn_user_valid(req->user, max_users)) return;
 
+    UserDB *shared_db = txn_bank_users(bank);
+    AccountDB *acc_db = txn_bank_accounts(bank);
     UserInfo *info = &shared_db->users[req->user];
     if (info->identifier != req->identifier) {
         printf("대출 실패: 사용자 인증 실패 (%d번)\n", req->user);
         return;
     }
 
+    // 사용자 줄무늬(부채와 카드 잔액) → 은행 자금 순서로 잡는다. ATM/송금 처리기와 같은 순서다.
+    TxnLock *l = txn_locks_for(txn_bank_locks(bank), req->user);
+    int ok = 0, card = 0;
+    txn_lock(l);
+    txn_lock(&shared_db->bank_lock);
     if (shared_db->bank_funds >= req->amount) {
         info->debt += req->amount;
         shared_db->bank_funds -= req->amount;
-        printf("대출 성공: 사용자 %d 금액 %d\n", req->user, req->amount);
-    } else {
+        acc_db->accounts[req->user].card_balance += req->amount;
+        card = acc_db->accounts[req->user].card_balance;
+        ok = 1;
+    }
+    txn_unlock(&shared_db->bank_lock);
+    txn_unlock(l);
+
+    if (ok)
+        printf("대출 성공: 사용자 %d 금액 %d | 카드 잔액 %d원\n", req->user, req->amount, card);
+    else
         printf("대출 실패: 은행 자금 부족\n");
+}
+
+// 미리 나눠 둔 자기 몫의 대출 요청을 처리한다
+void loan_share_worker(const TxnBuckets *b, unsigned w, TxnBank *bank) {
+    size_t n;
+    const TxnRecord *recs = txn_bucket(b, w, &n);
+    for (size_t i = 0; i < n; i++) {
+        LoanReq req = {recs[i].amount, recs[i].user, txn_identifier(&recs[i]), recs[i].password};
+        handle_single_loan(&req, bank);
     }
 }
 
-int main(int argc, char *argv[]) {
-    if (argc != 2) {
-        fprintf(stderr, "사용법: %s <입력파일>\n", argv[0]);
-        return 1;
+// 큐에서 대출 요청을 꺼내 처리한다
+void loan_stream_worker(TxnStream *q, TxnBank *bank) {
+    TxnRecord batch[TXN_STREAM_BATCH];
+    size_t n;
+    while ((n = txn_stream_pop(q, batch, TXN_STREAM_BATCH)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            LoanReq req = {batch[i].amount, batch[i].user,
+                           txn_identifier(&batch[i]), batch[i].password};
+            handle_single_loan(&req, bank);
+        }
     }
+}
 
-    // 공유 메모리 생성 및 초기화
-    int shm_fd = shm_open(SHM_NAME, O_CREAT | O_RDWR, 0666);
-    if (shm_fd == -1) {
-        perror("shm_open 실패");
+int main(int argc, char *argv[]) {
+    // 부모가 --workers N 을 받았으면 TXN_WORKERS 로 넘어온다. 아니면 DEFAULT_WORKERS
+    num_workers = txn_workers_arg(&argc, argv, DEFAULT_WORKERS);
+    if (argc != 2 || !num_workers) {
+        fprintf(stderr, "사용법: %s [--workers N] <입력파일|->\n", argv[0]);
         return 1;
     }
+    max_users = txn_users_count(DEFAULT_USERS);
 
-    ftruncate(shm_fd, sizeof(UserDB));
-    UserDB *shared_db = mmap(NULL, sizeof(UserDB), PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
-    if (shared_db == MAP_FAILED) {
-        perror("mmap 실패");
+    // 실행기가 만든 공유 세그먼트를 붙인다. 단독 실행이면 직접 만들어 채운다.
+    TxnBank *bank = txn_bank_attach(&bank_shape);
+    if (bank) {
+        max_users = bank->users;
+    } else if (errno == ENOENT) {
+        bank = txn_bank_create(max_users, &bank_shape);
+        if (!bank) {
+            perror("공유 세그먼트 생성 실패");
+            return 1;
+        }
+        init_account_db(txn_bank_accounts(bank));
+        init_user_db(txn_bank_users(bank));
+        txn_users_report("공유 사용자 테이블", max_users, sizeof(UserInfo));
+        txn_bank_report(bank);
+    } else {
+        perror("공유 세그먼트 연결 실패");
         return 1;
     }
 
-    init_user_db(shared_db); // 공유 메모리 초기화
-
-    // 입력 파일 열기
-    FILE *fp = fopen(argv[1], "r");
-    if (!fp) {
+    // 입력: 부모가 넘긴 대출 배열 → 색인으로 대출 줄만 파싱 (일반 파일) → stdin 직접 읽기.
+    // 배열이 있으면 프로세스별 몫으로 한 번에 나누고, stdin 이면 고정 크기 큐로 흘려보내
+    // 건수 제한 없이 일정한 메모리로 처리한다. 어느 쪽이든 user % num_workers 로 나눈다.
+    TxnQueues *q = txn_queues_attach(1u << TXN_LOAN);
+    if (!q && txn_path_seekable(argv[1]))
+        q = txn_queues_build_types(argv[1], 1u << TXN_LOAN);
+    TxnBuckets work;
+    TxnReader rd;
+    TxnStream *qs = NULL;
+    if (q) {
+        size_t n;
+        const TxnRecord *loans = txn_queue(q, TXN_LOAN, &n);
+        if (txn_buckets_build(&work, &loans, &n, 1, num_workers) < 0) {
+            perror("작업 나누기 실패");
+            return 1;
+        }
+        txn_buckets_report(&work, "대출");
+    } else if (txn_reader_open(&rd, argv[1]) < 0) {
         perror("파일 열기 실패");
         return 1;
+    } else if (!(qs = txn_stream_create(num_workers))) {
+        perror("큐 생성 실패");
+        return 1;
     }
 
-    // 대출 요청만 저장
-    int type, amount, user, identifier, dummy_val;
-    while (fscanf(fp, "%d", &type) == 1) {
-        if (type == 2) {
-            fscanf(fp, "%d %d %d %d", &amount, &user, &identifier, &dummy_val);
-            if (loan_count < MAX_LOANS) {
-                loan_reqs[loan_count++] = (LoanReq){amount, user, identifier, dummy_val};
+    // fork하여 병렬 처리 (큐는 공유 매핑, 생산자 스레드는 fork 뒤에 띄운다)
+    unsigned forked = 0;
+    for (unsigned w = 1; w < num_workers; w++, forked++) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("fork 실패");
+            if (!q) {
+                // 이미 띄운 자식은 빈 큐가 닫힌 것을 보고 끝난다
+                for (unsigned i = 0; i < num_workers; i++)
+                    txn_stream_close(&qs[i]);
+                for (unsigned i = 0; i < forked; i++)
+                    wait(NULL);
+                return 1;
             }
-        } else {
-            fscanf(fp, "%*[^\n]\n"); // 나머지 줄 무시
+            break;
         }
-    }
-    fclose(fp);
-
-    // fork하여 병렬 처리
-    pid_t pid = fork();
-    if (pid == 0) {
-        // 자식: 짝수 인덱스
-        for (int i = 0; i < loan_count; i += 2) {
-            handle_single_loan(&loan_reqs[i], shared_db);
+        if (pid == 0) {
+            // 자식: user % num_workers == w 인 사용자
+            if (q)
+                loan_share_worker(&work, w, bank);
+            else
+                loan_stream_worker(&qs[w], bank);
+            exit(0);
         }
-        exit(0);
     }
 
-    // 부모: 홀수 인덱스
-    for (int i = 1; i < loan_count; i += 2) {
-        handle_single_loan(&loan_reqs[i], shared_db);
+    // 부모: user % num_workers == 0 인 사용자 (+ 생산자 스레드, 또는 못 띄운 자식의 몫)
+    if (q) {
+        for (unsigned w = 0; w < num_workers; w++)
+            if (w == 0 || w > forked)
+                loan_share_worker(&work, w, bank);
+    } else {
+        TxnProducer prod = {.rd = &rd, .queues = qs, .n = (int)num_workers,
+                            .mask = 1u << TXN_LOAN};
+        pthread_t ptid;
+        pthread_create(&ptid, NULL, txn_stream_producer, &prod);
+        loan_stream_worker(&qs[0], bank);
+        pthread_join(ptid, NULL);
+    }
+
+    for (unsigned w = 0; w < forked; w++)
+        wait(NULL);
+    int failed = 0;
+    if (q) {
+        txn_buckets_free(&work);
+        txn_queues_release(q);
+    } else {
+        failed = rd.err != 0;   // 읽기 오류: 잘린 입력으로 처리를 마쳤다
+        if (!failed)
+            txn_reader_report(&rd);
+        txn_reader_close(&rd);
+        txn_stream_destroy(qs, num_workers);
     }
-	
-	
-    wait(NULL);
 	print_cpu_time();
-    // 필요 시 공유 메모리 해제
-    // shm_unlink(SHM_NAME);
+    txn_bank_release(bank);
 
-    return 0;
+    return failed;
 }
 
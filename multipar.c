@@ -1,17 +1,21 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
-#include <fcntl.h>
 #include <sys/mman.h>
 #include <sys/wait.h>
 #include <string.h>
 #include <time.h>
 #include <math.h>
 #include <sys/resource.h>
+#include "txn_queues.h"
+#include "txn_users.h"
+#include "txn_bank.h"
+#include "txn_workers.h"
 
-#define MAX_USERS 1000
-#define SHM_NAME "/account_db_shm"
+#define DEFAULT_USERS 1000  // 실행 시 TXN_USERS 로 바꿀 수 있다
 
+// 계좌 DB 와 대출 DB 는 공유 세그먼트 하나에 있다 (txn_bank.h).
+// 대출 처리기(multichild.c)도 같은 구조체를 쓴다. 크기가 다르면 붙지 않는다.
 typedef struct {
     int user;
     int identifier;
@@ -20,12 +24,32 @@ typedef struct {
     int card_balance;
 } AccountInfo;
 
+// 계좌 칸과 사용자 칸은 세그먼트의 줄무늬 잠금(txn_bank_locks)이, 전역 자금은 옆의 잠금이 지킨다.
+// 잠금 순서: 사용자 줄무늬 → ATM/은행 자금 잠금 (txn_locks.h)
 typedef struct {
-    AccountInfo accounts[MAX_USERS + 1];
-    int bank_funds;
+    TxnLock atm_lock;
     int atm_funds;
+    _Alignas(TXN_BANK_LINE) AccountInfo accounts[];   // max_users + 1 칸
 } AccountDB;
 
+typedef struct {
+    int user;
+    int identifier;
+    int debt;
+    int credit_rank;
+} UserInfo;
+
+typedef struct {
+    TxnLock bank_lock;
+    int bank_funds;
+    _Alignas(TXN_BANK_LINE) UserInfo users[];   // max_users + 1 칸
+} UserDB;
+
+static const TxnBankShape bank_shape = {sizeof(AccountDB), sizeof(AccountInfo),
+                                        sizeof(UserDB), sizeof(UserInfo)};
+
+size_t max_users;  // 실행 시 정한 사용자 수 (txn_users.h)
+
 volatile double dummy = 0.0;
 void sim_load() {
     for (int i = 0; i < 100000; i++) dummy += sqrt(i);
@@ -46,9 +70,12 @@ void print_cpu_time() {
 }  
 
 void init_account_db(AccountDB *db) {
-    db->bank_funds = 500000;
+    if (txn_lock_init(&db->atm_lock) < 0) {
+        perror("ATM 자금 잠금 초기화 실패");
+        exit(1);
+    }
     db->atm_funds = 1000000;
-    for (int i = 1; i <= MAX_USERS; i++) {
+    for (size_t i = 1; i <= max_users; i++) {
         db->accounts[i].user = i;
         db->accounts[i].identifier = i;
         db->accounts[i].account = i;
@@ -57,72 +84,150 @@ void init_account_db(AccountDB *db) {
     }
 }
 
-void handle_atm(FILE *fp, AccountDB *shared_db) {
-    int type, amount, user, account, password;
-    while (fscanf(fp, "%d", &type) == 1) {
-        if (type == 1) {
-            fscanf(fp, "%d %d %d %d", &amount, &user, &account, &password);
-            sim_load();
-            if (user < 1 || user > MAX_USERS) continue;
-            AccountInfo *info = &shared_db->accounts[user];
-            if (info->account != account || info->password != password) {
-                printf("ATM 인증 실패: 사용자 %d\n", user);
-                continue;
-            }
-            if (amount >= 0) {
-                info->card_balance += amount;
-                shared_db->atm_funds += amount;
-                printf("ATM 입금: 사용자 %d 금액 %d원\n", user, amount);
-            } else {
-                int withdraw = -amount;
-                if (withdraw <= info->card_balance && withdraw <= shared_db->atm_funds) {
-                    info->card_balance -= withdraw;
-                    shared_db->atm_funds -= withdraw;
-                    printf("ATM 출금: 사용자 %d 금액 %d원\n", user, withdraw);
-                } else {
-                    printf("ATM 출금 실패: 사용자 %d 잔액 부족\n", user);
-                }
-            }
+void init_user_db(UserDB *db) {
+    if (txn_lock_init(&db->bank_lock) < 0) {
+        perror("은행 자금 잠금 초기화 실패");
+        exit(1);
+    }
+    db->bank_funds = 500000;
+    for (size_t i = 1; i <= max_users; i++) {
+        db->users[i].user = i;
+        db->users[i].identifier = i;
+        db->users[i].debt = 0;
+        db->users[i].credit_rank = (i - 1) % 5 + 1;
+    }
+}
+
+// 모든 프로세스가 끝난 뒤 세그먼트에 남은 결과 (대출금이 카드 잔액에 들어갔는지 확인용)
+void print_bank_summary(TxnBank *bank) {
+    AccountDB *acc = txn_bank_accounts(bank);
+    UserDB *loans = txn_bank_users(bank);
+    long long cards = 0, debt = 0;
+    for (size_t i = 1; i <= max_users; i++) {
+        cards += acc->accounts[i].card_balance;
+        debt += loans->users[i].debt;
+    }
+    printf("🏦 카드 잔액 합계 %lld원 | 대출 합계 %lld원 | 은행 자금 %d원 | ATM 자금 %d원\n",
+           cards, debt, loans->bank_funds, acc->atm_funds);
+
+    // ATM / 송금 / 대출 프로세스가 잡은 몫이 잠금마다 모여 있다
+    TxnLockStats st = txn_locks_stats(txn_bank_locks(bank));
+    txn_lock_stats_report(&st, "계좌 줄무늬");
+    TxnLockStats funds = {0, 0, 0};
+    txn_lock_stats_add(&funds, &acc->atm_lock);
+    txn_lock_stats_add(&funds, &loans->bank_lock);
+    txn_lock_stats_report(&funds, "ATM/은행 자금");
+}
+
+// 인증 정보는 바뀌지 않으므로 잠금 없이 본다. 잔액과 ATM 자금은 잠근 채 고치고, 출력은 푼 뒤에 한다.
+void handle_atm(const TxnQueues *q, AccountDB *shared_db, TxnLocks *locks) {
+    size_t n;
+    const TxnRecord *recs = txn_queue(q, TXN_ATM, &n);
+    for (size_t i = 0; i < n; i++) {
+        TxnRecord rec = recs[i];
+        int amount = rec.amount, user = rec.user, account = rec.account, password = rec.password;
+        sim_load();
+        if (!txn_user_valid(user, max_users)) continue;
+        AccountInfo *info = &shared_db->accounts[user];
+        if (info->account != account || info->password != password) {
+            printf("ATM 인증 실패: 사용자 %d\n", user);
+            continue;
+        }
+        int withdraw = -amount, ok = 1;
+        TxnLock *l = txn_locks_for(locks, user);
+        txn_lock(l);
+        txn_lock(&shared_db->atm_lock);
+        if (amount >= 0) {
+            info->card_balance += amount;
+            shared_db->atm_funds += amount;
+        } else if (withdraw <= info->card_balance && withdraw <= shared_db->atm_funds) {
+            info->card_balance -= withdraw;
+            shared_db->atm_funds -= withdraw;
         } else {
-            continue; // 잘못된 type이면 무시
+            ok = 0;
         }
+        txn_unlock(&shared_db->atm_lock);
+        txn_unlock(l);
+
+        if (amount >= 0)
+            printf("ATM 입금: 사용자 %d 금액 %d원\n", user, amount);
+        else if (ok)
+            printf("ATM 출금: 사용자 %d 금액 %d원\n", user, withdraw);
+        else
+            printf("ATM 출금 실패: 사용자 %d 잔액 부족\n", user);
     }
 }
 
-void handle_mobile(FILE *fp, AccountDB *shared_db) {
-    int type, amount, sender, account, password, receiver;
-    while (fscanf(fp, "%d", &type) == 1) {
-        if (type == 3) {
-            fscanf(fp, "%d %d %d %d %d", &amount, &sender, &account, &password, &receiver);
-            sim_load();
-            if (sender < 1 || sender > MAX_USERS || receiver < 1 || receiver > MAX_USERS) continue;
-            AccountInfo *s = &shared_db->accounts[sender];
-            AccountInfo *r = &shared_db->accounts[receiver];
-            if (s->account != account || s->password != password) {
-                printf("송금 실패: 계좌번호 또는 비밀번호 불일치 (송금자 %d번)\n\n", sender);
-                continue;
-            }
-            if (s->card_balance < amount) {
-                printf("송금 실패: 잔액 부족 (송금자 %d번, 필요: %d, 보유: %d)\n\n",
-                       sender, amount, s->card_balance);
-                continue;
-            }
+// 송금자와 수신자의 줄무늬를 정해진 순서로 잡는다 (같은 줄무늬면 한 번)
+void handle_mobile(const TxnQueues *q, AccountDB *shared_db, TxnLocks *locks) {
+    size_t n;
+    const TxnRecord *recs = txn_queue(q, TXN_TRANSFER, &n);
+    for (size_t i = 0; i < n; i++) {
+        TxnRecord rec = recs[i];
+        int amount = rec.amount, sender = rec.user, account = rec.account,
+            password = rec.password, receiver = rec.receiver;
+        sim_load();
+        if (!txn_user_valid(sender, max_users) || !txn_user_valid(receiver, max_users)) continue;
+        AccountInfo *s = &shared_db->accounts[sender];
+        AccountInfo *r = &shared_db->accounts[receiver];
+        if (s->account != account || s->password != password) {
+            printf("송금 실패: 계좌번호 또는 비밀번호 불일치 (송금자 %d번)\n\n", sender);
+            continue;
+        }
+        TxnLock *held[2];
+        txn_locks_lock_pair(locks, sender, receiver, held);
+        int have = s->card_balance;
+        if (have >= amount) {
             s->card_balance -= amount;
             r->card_balance += amount;
-            printf("송금 성공: %d번 → %d번, 금액: %d\n", sender, receiver, amount);
-            printf("송금자 남은 잔액: %d\n", s->card_balance);
-            printf("수신자 새로운 잔액: %d\n\n", r->card_balance);
-        } else {
-            continue; // 잘못된 type이면 무시
         }
+        int s_after = s->card_balance, r_after = r->card_balance;
+        txn_locks_unlock_pair(held);
+
+        if (have < amount) {
+            printf("송금 실패: 잔액 부족 (송금자 %d번, 필요: %d, 보유: %d)\n\n",
+                   sender, amount, have);
+            continue;
+        }
+        printf("송금 성공: %d번 → %d번, 금액: %d\n", sender, receiver, amount);
+        printf("송금자 남은 잔액: %d\n", s_after);
+        printf("수신자 새로운 잔액: %d\n\n", r_after);
     }
 }
 
 int main(int argc, char *argv[]) {
-    if (argc != 2) {
-        fprintf(stderr, "사용법: %s <입력파일>\n", argv[0]);
+    // --workers N 은 대출 처리기(multi_loan_handler)의 워커 수다. TXN_WORKERS 로 넘겨준다.
+    int workers = txn_workers_opt(&argc, argv);
+    if (argc != 2 || workers < 0) {
+        fprintf(stderr, "사용법: %s [--workers N] <입력파일|->\n", argv[0]);
         return 1;
     }
+    max_users = txn_users_count(DEFAULT_USERS);
+    struct timespec start_time, end_time;
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+
+    // 부모는 ATM/송금 줄만 색인으로 골라 파싱하고, ATM 자식은 그 매핑을 상속한다.
+    // exec 된 대출 자식은 세그먼트에 대출이 없으므로 색인으로 대출 줄만 따로 파싱한다.
+    TxnQueues *q = txn_queues_build_types(argv[1], (1u << TXN_ATM) | (1u << TXN_TRANSFER));
+    if (!q) {
+        perror("파일 열기 실패");
+        return 1;
+    }
+
+    // 계좌 DB 와 대출 DB 를 여기서 한 번 만들고 채운 뒤 자식들을 띄운다.
+    // exec 된 대출 처리기는 TXN_BANK_FD 로 같은 세그먼트를 붙인다.
+    TxnBank *bank = txn_bank_create(max_users, &bank_shape);
+    if (!bank) {
+        perror("공유 세그먼트 생성 실패");
+        return 1;
+    }
+    AccountDB *shared_db = txn_bank_accounts(bank);
+    init_account_db(shared_db);
+    init_user_db(txn_bank_users(bank));
+    txn_users_report("공유 계좌 테이블", max_users, sizeof(AccountInfo));
+    txn_users_report("공유 사용자 테이블", max_users, sizeof(UserInfo));
+    txn_bank_report(bank);
+    txn_locks_report(txn_bank_locks(bank), "공유 계좌");
 
     pid_t loan_pid = fork();
     if (loan_pid == 0) {
@@ -131,33 +236,24 @@ int main(int argc, char *argv[]) {
         exit(1);
     }
 
-    int shm_fd = shm_open(SHM_NAME, O_CREAT | O_RDWR, 0666);
-    ftruncate(shm_fd, sizeof(AccountDB));
-    AccountDB *shared_db = mmap(NULL, sizeof(AccountDB), PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
-    init_account_db(shared_db);
-
     pid_t atm_pid = fork();
     if (atm_pid == 0) {
-        FILE *fp = fopen(argv[1], "r");
-        if (!fp) exit(1);
-        handle_atm(fp, shared_db);
-        fclose(fp);
+        handle_atm(q, shared_db, txn_bank_locks(bank));
         exit(0);
     }
 
-    FILE *fp = fopen(argv[1], "r");
-    if (!fp) exit(1);
-    handle_mobile(fp, shared_db);
-    fclose(fp);
+    handle_mobile(q, shared_db, txn_bank_locks(bank));
 
     wait(NULL); wait(NULL); wait(NULL);
     clock_gettime(CLOCK_MONOTONIC, &end_time);
     double wall_sec = (end_time.tv_sec - start_time.tv_sec)
                     + (end_time.tv_nsec - start_time.tv_nsec) / 1e9;
 
+    print_bank_summary(bank);
     print_cpu_time();
     printf("⏱ 전체 실행 시간 (Wall-clock): %.6f 초\n\n", wall_sec);
-    shm_unlink(SHM_NAME);
+    txn_bank_release(bank);
+    txn_queues_release(q);
     return 0;
 }
 
@@ -4,10 +4,19 @@
 #include <math.h>
 #include <sys/resource.h>
 #include <time.h>
-
-#define MAX_USERS 5000000
-#define NUM_WORKERS 4
-#define MAX_TASKS 10000
+#include "txn_stream.h"
+#include "txn_sparse.h"
+#include "txn_init.h"
+#include "txn_snapshot.h"
+#include "txn_users.h"
+#include "txn_atomic.h"
+#include "txn_steal.h"
+
+#define DEFAULT_USERS 5000000  // 실행 시 TXN_USERS 로 바꿀 수 있다
+#define DEFAULT_WORKERS 4   // 실행 시 --workers N 이나 TXN_WORKERS 로 바꿀 수 있다
+#define CREDIT_RANKS 5
+#define USER_SNAPSHOT "n_a_child.snap"   // --build-snapshot 으로 만든다
+#define USER_KIND "n_a_child 사용자"
 // ---------- 구조체 정의 ----------
 
 typedef struct {
@@ -19,7 +28,7 @@ typedef struct {
 
 typedef struct {
     UserInfo *users;
-    int bank_funds;
+    _Atomic int bank_funds;   // 여러 워커가 다른 사용자의 대출을 동시에 처리한다 (txn_atomic.h)
 } UserDB;
 
 typedef struct {
@@ -30,9 +39,12 @@ typedef struct {
 
 // ---------- 전역 포인터 변수 ----------
 
+size_t max_users;  // 실행 시 정한 사용자 수 (txn_users.h)
+unsigned num_workers;  // 실행 시 정한 워커 수 (txn_workers.h)
 UserDB *loan_db;
-LoanTask loan_tasks[MAX_TASKS];
-int loan_cnt = 0;
+TxnInit init_stats;
+TxnHuge user_pages;
+uint32_t rank_seed;
 
 // ---------- 로딩 시뮬레이션 ----------
 
@@ -44,18 +56,72 @@ void database_sim_load() {
 }
 // ---------- 초기화 ----------
 
+// 사용자 [begin, end) 를 채운다. 등급은 여러 스레드가 rand() 를 나눠 쓰지 않도록
+// 시드와 사용자 번호로 정한다 (new/laonchild.c 와 같은 방식).
+void init_user_range(size_t begin, size_t end, void *ctx) {
+    UserInfo *users = ctx;
+    for (size_t i = begin; i < end; i++)
+        database_sim_load();
+    TXN_INIT_VEC(i, begin, end, {
+        users[i].user = (int)i;
+        users[i].identifier = (int)i;
+        users[i].debt = 0;
+        users[i].credit_rank = (int)(txn_sparse_mix(rank_seed ^ (uint32_t)i) % CREDIT_RANKS) + 1;
+    });
+}
+
+// 스냅샷이 담아야 하는 사용자 테이블의 모양. 등급 수가 바뀌면 옛 스냅샷은 버린다.
+// 등급은 스냅샷을 만든 실행의 시드로 정해진 채 남는다.
+TxnSnapSpec user_snapshot_spec() {
+    return (TxnSnapSpec){USER_KIND, max_users, sizeof(UserInfo), CREDIT_RANKS,
+                         txn_users_bytes(sizeof(UserInfo), max_users)};
+}
+
+// 모든 사용자를 계산해서 채운다.
+void build_user_db() {
+    loan_db->users = txn_init_alloc(&user_pages, txn_users_bytes(sizeof(UserInfo), max_users));
+    if (!loan_db->users) {
+        perror("사용자 테이블 할당 실패");
+        exit(1);
+    }
+    rank_seed = (uint32_t)rand();
+    txn_init_parallel(&init_stats, 1, max_users + 1, init_user_range, loan_db->users);
+    txn_huge_report(&user_pages, "사용자 테이블");
+}
+
 void init_user_db() {
     loan_db = malloc(sizeof(UserDB));
-    loan_db->users = malloc(sizeof(UserInfo) * (MAX_USERS + 1));
     loan_db->bank_funds = 2000000000;
 
-    for (int i = 1; i <= MAX_USERS; i++) {
-    	database_sim_load();
-        loan_db->users[i].user = i;
-        loan_db->users[i].identifier = i;
-        loan_db->users[i].debt = 0;
-        loan_db->users[i].credit_rank = (rand() % 5) + 1;
+    // 맞는 스냅샷이 있으면 매핑만 한다. 부채가 바뀌는 페이지만 이 프로세스 안에서 복사된다.
+    TxnSnapSpec spec = user_snapshot_spec();
+    txn_users_report("사용자 테이블", max_users, spec.elem);
+    TxnSnapshot snap;
+    loan_db->users = txn_snapshot_map(&snap, USER_SNAPSHOT, &spec);
+    if (loan_db->users) {
+        init_stats.snapshot = 1;
+        init_stats.sec = snap.load_sec;
+        txn_snapshot_report(&snap, USER_SNAPSHOT);
+        return;
     }
+    printf("📸 %s (%s): 전체 초기화\n", txn_snapshot_why(errno), USER_SNAPSHOT);
+    build_user_db();
+}
+
+// --build-snapshot: 사용자 테이블을 계산해서 스냅샷 파일로 쓴다.
+int build_user_snapshot() {
+    srand(time(NULL));
+    loan_db = malloc(sizeof(UserDB));
+    build_user_db();
+
+    TxnSnapSpec spec = user_snapshot_spec();
+    if (txn_snapshot_save(USER_SNAPSHOT, &spec, loan_db->users) < 0) {
+        perror("스냅샷 저장 실패");
+        return 1;
+    }
+    printf("📸 스냅샷 저장: %s | %.1f MB | 초기화 %.6f 초 (스레드 %d개)\n", USER_SNAPSHOT,
+           spec.payload_bytes / (1024.0 * 1024.0), init_stats.sec, init_stats.threads);
+    return 0;
 }
 
 // ---------- 로딩 시뮬레이션 ----------
@@ -103,20 +169,8 @@ void print_cpu_time() {
 
 // ---------- 기능 처리 함수 ----------
 
-void *worker_thread(void *arg) {
-    int thread_id = *(int *)arg;
-    free(arg);  // 동적 할당된 thread_id 해제
-
-    for (int i = 0; i < loan_cnt; i++) {
-        if (loan_tasks[i].user % NUM_WORKERS == thread_id) {
-            handle_single_loan(loan_tasks[i].amount, loan_tasks[i].user, loan_tasks[i].identifier);
-        }
-    }
-    return NULL;
-}
-
 void handle_single_loan(int user, int amount, int identifier) {
-    if (user < 1 || user > MAX_USERS) {
+    if (!txn_user_valid(user, max_users)) {
         printf("대출 실패: 잘못된 사용자 번호 %d\n", user);
         return;
     }
@@ -157,27 +211,40 @@ void handle_single_loan(int user, int amount, int identifier) {
     printf("대출 요청: 사용자 %d | 등급 %d | 최종 대출 금액: %d원\n",
            user, credit, amount);
 
-    if (loan_db->bank_funds >= amount) {
-        info->debt += amount;
-        loan_db->bank_funds -= amount;
+    if (txn_atomic_take(&loan_db->bank_funds, amount)) {
+        info->debt += amount;   // 한 사용자의 거래는 한 워커만 처리한다
         printf("대출 승인\n");
-        printf("은행 자금: %d원 → %d원\n", bank_before, loan_db->bank_funds);
+        // 다른 워커도 동시에 빼므로 두 값 사이에 다른 대출이 끼어 있을 수 있다
+        printf("은행 자금: %d원 → %d원\n", bank_before, atomic_load(&loan_db->bank_funds));
         printf("사용자(%d번) 부채: %d원 → %d원\n\n", user, user_debt_before, info->debt);
     } else {
         printf("대출 실패: 은행 자금 부족 (요청 %d원, 보유 %d원)\n\n",
-               amount, loan_db->bank_funds);
+               amount, atomic_load(&loan_db->bank_funds));
     }
 }
 
 // ---------- 워커 스레드 ----------
-void *loan_worker(void *arg) {
-    int thread_id = *(int *)arg;
-    free(arg);
+// 사용자 한 명의 대출 묶음 (파일 순서). 워커들이 묶음 단위로 훔쳐 간다 (txn_steal.h)
+void loan_group(const TxnRecord *recs, size_t n, void *ctx) {
+    (void)ctx;
+    if (txn_user_valid(recs[0].user, max_users))
+        __builtin_prefetch(&loan_db->users[recs[0].user], 1, 3);
+    for (size_t i = 0; i < n; i++)
+        handle_single_loan(recs[i].user, recs[i].amount, txn_identifier(&recs[i]));
+}
 
-    for (int i = 0; i < loan_cnt; i++) {
-        if (loan_tasks[i].user % NUM_WORKERS == thread_id) {
-            handle_single_loan(loan_tasks[i].user, loan_tasks[i].amount, loan_tasks[i].identifier);
-        }
+// 자기 큐(user % num_workers)에서 대출 요청을 꺼내 처리한다
+void *loan_worker(void *arg) {
+    TxnStream *q = arg;
+    TxnRecord batch[TXN_STREAM_BATCH];
+    size_t n;
+    while ((n = txn_stream_pop(q, batch, TXN_STREAM_BATCH)) > 0) {
+        // 묶음의 사용자 칸을 먼저 모두 선읽기해 두면 미스를 건마다가 아니라 한꺼번에 기다린다
+        for (size_t i = 0; i < n; i++)
+            if (txn_user_valid(batch[i].user, max_users))
+                __builtin_prefetch(&loan_db->users[batch[i].user], 1, 3);
+        for (size_t i = 0; i < n; i++)
+            handle_single_loan(batch[i].user, batch[i].amount, txn_identifier(&batch[i]));
     }
     return NULL;
 }
@@ -185,10 +252,20 @@ void *loan_worker(void *arg) {
 // ---------- 메인 ----------
 
 int main(int argc, char *argv[]) {
-    if (argc != 2) {
-        fprintf(stderr, "사용법: %s <입력파일>\n", argv[0]);
+    // 부모가 --workers N 을 받았으면 TXN_WORKERS 로 넘어온다. 아니면 DEFAULT_WORKERS
+    num_workers = txn_workers_arg(&argc, argv, DEFAULT_WORKERS);
+    if (argc == 2 && strcmp(argv[1], "--build-snapshot") == 0) {
+        max_users = txn_users_count(DEFAULT_USERS);
+        return build_user_snapshot();
+    }
+    if (argc != 2 || !num_workers) {
+        fprintf(stderr, "사용법: %s [--workers N] <입력파일|-> | --build-snapshot\n", argv[0]);
         return 1;
     }
+    // 부모가 exec 했으면 TXN_USERS 에 부모의 사용자 수가 들어 있다.
+    // 따로 실행했고 TXN_USERS 도 없으면 스냅샷을 만든 때의 사용자 수를 따른다.
+    uint64_t snap_users = txn_snapshot_count(USER_SNAPSHOT, USER_KIND);
+    max_users = txn_users_count(snap_users ? snap_users : DEFAULT_USERS);
 
     const char *filename = argv[1];
     srand(time(NULL));
@@ -196,46 +273,70 @@ int main(int argc, char *argv[]) {
     struct timespec start_time, end_time;
     clock_gettime(CLOCK_MONOTONIC, &start_time);
 
-    FILE *fp = fopen(filename, "r");
-    if (!fp) {
+    // 입력: 부모가 넘긴 대출 배열이 있으면 사용자별로 묶어 워커들이 훔쳐 가며 처리한다.
+    // 없으면 파일/stdin 을 직접 읽어 고정 크기 큐로 흘려보낸다 (건수 제한 없이 일정한 메모리).
+    TxnQueues *q = txn_queues_attach(1u << TXN_LOAN);
+    TxnReader rd;
+    TxnGroups groups;
+    if (q) {
+        size_t n;
+        const TxnRecord *loans = txn_queue(q, TXN_LOAN, &n);
+        if (txn_groups_build(&groups, &loans, &n, 1) < 0) {
+            perror("작업 묶기 실패");
+            return 1;
+        }
+        txn_queues_release(q);
+    } else if (txn_reader_open(&rd, filename) < 0) {
         perror("파일 열기 실패");
         return 1;
     }
 
     init_user_db();
 
-    int type, amount, user, account, password, receiver, identifier;
-    while (fscanf(fp, "%d", &type) == 1) {
-        if (type == 2) {
-            if (fscanf(fp, "%d %d %d", &amount, &user, &identifier) == 3) {
-                if (loan_cnt < MAX_TASKS) {
-                    loan_tasks[loan_cnt++] = (LoanTask){amount, user, identifier};
-                }
-            }
-        } else {
-            char buf[256];
-            fgets(buf, sizeof(buf), fp);
+    if (q) {
+        TxnSteal pool;
+        if (txn_steal_run(&pool, &groups, num_workers, loan_group, NULL) < 0) {
+            perror("워커 생성 실패");
+            return 1;
+        }
+        txn_steal_report(&pool);
+        txn_steal_free(&pool);
+        txn_groups_free(&groups);
+    } else {
+        TxnStream *qs = txn_stream_create(num_workers);
+        if (!qs) {
+            perror("큐 생성 실패");
+            return 1;
         }
-    }
-    fclose(fp);
 
-    pthread_t threads[NUM_WORKERS];
-    for (int i = 0; i < NUM_WORKERS; i++) {
-        int *arg = malloc(sizeof(int));
-        *arg = i;
-        pthread_create(&threads[i], NULL, loan_worker, arg);
-    }
+        pthread_t threads[TXN_WORKERS_MAX];
+        for (unsigned i = 0; i < num_workers; i++) {
+            pthread_create(&threads[i], NULL, loan_worker, &qs[i]);
+        }
 
-    for (int i = 0; i < NUM_WORKERS; i++) {
-        pthread_join(threads[i], NULL);
-    }
+        // 메인 스레드가 생산자: 큐가 차면 여기서 멈추고 입력 읽기도 멈춘다
+        TxnProducer prod = {.rd = &rd, .queues = qs, .n = (int)num_workers,
+                            .mask = 1u << TXN_LOAN};
+        txn_stream_producer(&prod);
 
+        for (unsigned i = 0; i < num_workers; i++) {
+            pthread_join(threads[i], NULL);
+        }
+        int err = rd.err;
+        if (!err)
+            txn_reader_report(&rd);
+        txn_reader_close(&rd);
+        txn_stream_destroy(qs, num_workers);
+        if (err)
+            return 1;   // 읽기 오류: 잘린 입력으로 처리를 마쳤다
+    }
 
     clock_gettime(CLOCK_MONOTONIC, &end_time);
     double wall_sec = (end_time.tv_sec - start_time.tv_sec)
                     + (end_time.tv_nsec - start_time.tv_nsec) / 1e9;
 
     print_cpu_time();
+    txn_init_report(&init_stats, wall_sec);
     printf("⏱ 전체 실행 시간 (Wall-clock): %.6f 초\n\n", wall_sec);
 
     return 0;
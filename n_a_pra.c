@@ -4,27 +4,34 @@
 #include <math.h>
 #include <sys/resource.h>
 #include <time.h>
-
-#define MAX_USERS 5000000
+#include "txn_queues.h"
+#include "txn_accounts.h"
+#include "txn_init.h"
+#include "txn_snapshot.h"
+#include "txn_users.h"
+#include "txn_acctmap.h"
+#include "txn_workers.h"
+
+#define DEFAULT_USERS 5000000  // 실행 시 TXN_USERS 로 바꿀 수 있다
 #define NUM_ATMS 1
+#define DEFAULT_BALANCE 10000000
+#define ACCOUNT_SNAPSHOT "n_a_pra.snap"   // --build-snapshot 으로 만든다
+#define ACCOUNT_KIND "n_a_pra 계좌"
 
 // ---------- 구조체 정의 ----------
 
+// 계좌는 열 저장소(txn_accounts.h)에 둔다: 잔액 / 계좌번호·비밀번호 / 사용자 번호
 typedef struct {
-    int user;
-    int account;
-    int password;
-    int card_balance;
-} AccountInfo;
-
-typedef struct {
-    AccountInfo *accounts;
+    TxnAccounts accounts;
     int *atm_funds;
 } AccountDB;
 
 // ---------- 전역 포인터 변수 ----------
 
+size_t max_users;  // 실행 시 정한 사용자 수 (txn_users.h)
 AccountDB *acc_db;
+TxnInit init_stats;
+TxnAcctMap acct_index;   // 계좌번호 → 계좌 칸
 
 
 // ---------- 로딩 시뮬레이션 ----------
@@ -37,19 +44,92 @@ void database_sim_load() {
 }
 // ---------- 초기화 ----------
 
+// 사용자 [begin, end) 를 채운다. 열마다 따로 돌려 각 루프가 벡터화되게 한다.
+void init_account_range(size_t begin, size_t end, void *ctx) {
+    TxnAccounts *acc = ctx;
+    for (size_t i = begin; i < end; i++)
+        database_sim_load();
+    TXN_INIT_VEC(i, begin, end, { acc->user[i] = (int)i; });
+    TXN_INIT_VEC(i, begin, end, {
+        acc->cred[i].account = (int)i;
+        acc->cred[i].password = (int)i;
+    });
+    TXN_INIT_VEC(i, begin, end, { acc->balance[i] = DEFAULT_BALANCE; });
+}
+
+// 스냅샷이 담아야 하는 계좌 열의 모양. 기본 잔액이 바뀌면 옛 스냅샷은 버린다.
+TxnSnapSpec account_snapshot_spec() {
+    size_t b_bytes, c_bytes;
+    size_t bytes = txn_accounts_layout(max_users, &b_bytes, &c_bytes);
+    return (TxnSnapSpec){ACCOUNT_KIND, max_users,
+                         sizeof(int) + sizeof(TxnCred) + sizeof(int), DEFAULT_BALANCE, bytes};
+}
+
+// 모든 계좌를 계산해서 채운다.
+void build_account_db() {
+    if (txn_accounts_create(&acc_db->accounts, max_users) < 0) {
+        perror("계좌 저장소 할당 실패");
+        exit(1);
+    }
+    // 열은 아직 페이지가 붙지 않았으므로 각 구간을 맡은 스레드 쪽에 놓인다
+    txn_init_parallel(&init_stats, 1, max_users + 1, init_account_range, &acc_db->accounts);
+    txn_huge_report(&acc_db->accounts.huge, "계좌 열");
+}
+
 void init_account_db() {
     acc_db = malloc(sizeof(AccountDB));
-    acc_db->accounts = malloc(sizeof(AccountInfo) * (MAX_USERS + 1));
     acc_db->atm_funds = malloc(sizeof(int) * NUM_ATMS);
     acc_db->atm_funds[0] = 10000000;
 
-    for (int i = 1; i <= MAX_USERS; i++) {
-    	database_sim_load();
-        acc_db->accounts[i].user = i;
-        acc_db->accounts[i].account = i;
-        acc_db->accounts[i].password = i;
-        acc_db->accounts[i].card_balance = 10000000;
+    // 맞는 스냅샷이 있으면 매핑만 한다. 바뀌는 페이지는 이 프로세스 안에서만 복사된다.
+    TxnSnapSpec spec = account_snapshot_spec();
+    txn_users_report("계좌 열", max_users, spec.elem);
+    TxnSnapshot snap;
+    void *cols = txn_snapshot_map(&snap, ACCOUNT_SNAPSHOT, &spec);
+    if (cols) {
+        txn_accounts_attach(&acc_db->accounts, max_users, cols, snap.base, snap.bytes);
+        init_stats.snapshot = 1;
+        init_stats.sec = snap.load_sec;
+        txn_snapshot_report(&snap, ACCOUNT_SNAPSHOT);
+        return;
+    }
+    printf("📸 %s (%s): 전체 초기화\n", txn_snapshot_why(errno), ACCOUNT_SNAPSHOT);
+    build_account_db();
+}
+
+// 계좌번호 열로 색인을 만든다. 계좌 칸은 사용자 순서이고, 계좌번호는 어떤 값이든 된다.
+void build_account_index() {
+    TxnAccounts *acc = &acc_db->accounts;
+    unsigned long long t0 = txn_now_ns();
+    if (txn_acctmap_create(&acct_index, acc->n) < 0) {
+        perror("계좌번호 색인 할당 실패");
+        exit(1);
+    }
+    for (size_t i = 1; i <= acc->n; i++) {
+        if (i + TXN_ACCTMAP_BATCH <= acc->n)
+            txn_acctmap_prefetch(&acct_index, (uint32_t)acc->cred[i + TXN_ACCTMAP_BATCH].account);
+        if (txn_acctmap_insert(&acct_index, (uint32_t)acc->cred[i].account, (uint32_t)i) < 0) {
+            perror("계좌번호 색인 추가 실패");
+            exit(1);
+        }
+    }
+    acct_index.build_sec = (txn_now_ns() - t0) / 1e9;
+    txn_acctmap_report(&acct_index, "계좌번호");
+}
+
+// --build-snapshot: 계좌를 계산해서 스냅샷 파일로 쓴다.
+int build_account_snapshot() {
+    acc_db = malloc(sizeof(AccountDB));
+    build_account_db();
+
+    TxnSnapSpec spec = account_snapshot_spec();
+    if (txn_snapshot_save(ACCOUNT_SNAPSHOT, &spec, acc_db->accounts.base) < 0) {
+        perror("스냅샷 저장 실패");
+        return 1;
     }
+    printf("📸 스냅샷 저장: %s | %.1f MB | 초기화 %.6f 초 (스레드 %d개)\n", ACCOUNT_SNAPSHOT,
+           spec.payload_bytes / (1024.0 * 1024.0), init_stats.sec, init_stats.threads);
+    return 0;
 }
 
 // ---------- 로딩 시뮬레이션 ----------
@@ -87,48 +167,49 @@ void print_cpu_time() {
 
 // ---------- 기능 처리 함수 ----------
 
-void atm_worker_line(int amount, int user, int account, int password) {
-    if (user < 1 || user > MAX_USERS) {
+// slot: 요청의 계좌번호로 찾은 계좌 칸 (txn_acctmap_find_batch)
+void atm_worker_line(int amount, int user, uint32_t slot, int password) {
+    if (!txn_user_valid(user, max_users)) {
         printf("ATM 처리 실패: 잘못된 사용자 번호 %d\n", user);
         return;
     }
 
     sim_load();
-    AccountInfo *info = &acc_db->accounts[user];
-
-    if (info->account != account || info->password != password) {
+    TxnAccounts *acc = &acc_db->accounts;
+    if (!txn_accounts_auth_slot(acc, slot, user, password)) {
         printf("ATM 인증 실패: 사용자 %d\n", user);
         return;
     }
+    int *balance = &acc->balance[slot];
 
-    int user_before = info->card_balance;
+    int user_before = *balance;
     int atm_before = acc_db->atm_funds[0];
 
     if (amount >= 0) {
         // 입금 처리
-        info->card_balance += amount;
+        *balance += amount;
         acc_db->atm_funds[0] += amount;
 
         printf("ATM 입금 성공: 사용자(%d번) | 금액: %d원\n", user, amount);
-        printf("사용자(%d번) 잔액: %d원 → %d원\n", user, user_before, info->card_balance);
+        printf("사용자(%d번) 잔액: %d원 → %d원\n", user, user_before, *balance);
         printf("ATM 자금: %d원 → %d원\n\n", atm_before, acc_db->atm_funds[0]);
     } else {
         // 출금 처리
         int withdraw = -amount;
 
-        if (withdraw <= info->card_balance && withdraw <= acc_db->atm_funds[0]) {
+        if (withdraw <= *balance && withdraw <= acc_db->atm_funds[0]) {
             // 출금 성공
-            info->card_balance -= withdraw;
+            *balance -= withdraw;
             acc_db->atm_funds[0] -= withdraw;
 
             printf("ATM 출금 성공: 사용자(%d번) | 금액: %d원\n", user, withdraw);
-            printf("사용자(%d번) 잔액: %d원 → %d원\n", user, user_before, info->card_balance);
+            printf("사용자(%d번) 잔액: %d원 → %d원\n", user, user_before, *balance);
             printf("ATM 자금: %d원 → %d원\n\n", atm_before, acc_db->atm_funds[0]);
         } else {
             // 출금 실패: 사유별 메시지
             printf("ATM 출금 실패: 사용자(%d번) | 요청: %d원\n", user, withdraw);
-            if (withdraw > info->card_balance) {
-                printf("사용자(%d번) 잔액 부족: 보유 %d원\n", user, info->card_balance);
+            if (withdraw > *balance) {
+                printf("사용자(%d번) 잔액 부족: 보유 %d원\n", user, *balance);
             }
             if (withdraw > acc_db->atm_funds[0]) {
                 printf("ATM 자금 부족: 기기 보유 %d원\n", acc_db->atm_funds[0]);
@@ -140,50 +221,61 @@ void atm_worker_line(int amount, int user, int account, int password) {
 
 
 
-void mobile_app_transfer(int amount, int name, int account, int password, int receiver) {
-    if (name < 1 || name > MAX_USERS || receiver < 1 || receiver > MAX_USERS) {
+// slot: 송금자 계좌번호로 찾은 칸. 수신자는 사용자 번호로 오므로 그 사용자의 칸을 쓴다.
+void mobile_app_transfer(int amount, int name, uint32_t slot, int password, int receiver) {
+    if (!txn_user_valid(name, max_users) || !txn_user_valid(receiver, max_users)) {
         printf("송금 실패: 잘못된 사용자 번호 (송금자 %d, 수신자 %d)\n", name, receiver);
         return;
     }
 
     sim_load();
-    AccountInfo *sender = &acc_db->accounts[name];
-    AccountInfo *recv   = &acc_db->accounts[receiver];
+    TxnAccounts *acc = &acc_db->accounts;
     int real_amount = abs(amount);
 
-    if (sender->account != account || sender->password != password) {
+    if (!txn_accounts_auth_slot(acc, slot, name, password)) {
         printf("모바일 송금 실패: 계좌번호 또는 비밀번호 불일치 (송금자 %d번)\n\n", name);
         return;
     }
+    int *sender = &acc->balance[slot];
+    int *recv   = &acc->balance[receiver];
 
-    if (sender->card_balance < real_amount) {
+    if (*sender < real_amount) {
         printf("모바일 송금 실패: 잔액 부족 (송금자 %d번, 필요: %d, 보유: %d)\n\n",
-               name, real_amount, sender->card_balance);
+               name, real_amount, *sender);
         return;
     }
 
     // 전 잔액 저장
-    int sender_before = sender->card_balance;
-    int receiver_before = recv->card_balance;
+    int sender_before = *sender;
+    int receiver_before = *recv;
 
     // 송금 수행
-    sender->card_balance -= real_amount;
-    recv->card_balance   += real_amount;
+    *sender -= real_amount;
+    *recv   += real_amount;
 
     // 출력
     printf("모바일 송금 성공: %d번 → %d번 | 금액: %d원\n", name, receiver, real_amount);
-    printf("송금자(%d번) 잔액: %d원 → %d원\n", name, sender_before, sender->card_balance);
-    printf("수신자(%d번) 잔액: %d원 → %d원\n\n", receiver, receiver_before, recv->card_balance);
+    printf("송금자(%d번) 잔액: %d원 → %d원\n", name, sender_before, *sender);
+    printf("수신자(%d번) 잔액: %d원 → %d원\n\n", receiver, receiver_before, *recv);
 }
 
 
 // ---------- 메인 ----------
 
 int main(int argc, char *argv[]) {
-    if (argc != 2) {
-        fprintf(stderr, "사용법: %s <입력파일>\n", argv[0]);
+    // --workers N 은 대출 자식(loanchild)의 워커 수다. TXN_WORKERS 로 넘겨준다.
+    int workers = txn_workers_opt(&argc, argv);
+    if (argc == 2 && strcmp(argv[1], "--build-snapshot") == 0) {
+        max_users = txn_users_count(DEFAULT_USERS);
+        return build_account_snapshot();
+    }
+    if (argc != 2 || workers < 0) {
+        fprintf(stderr, "사용법: %s [--workers N] <입력파일|-> | --build-snapshot\n", argv[0]);
         return 1;
     }
+    // TXN_USERS 가 없으면 스냅샷을 만든 때의 사용자 수를 따른다. 대출 자식도 같은 값을 받는다.
+    uint64_t snap_users = txn_snapshot_count(ACCOUNT_SNAPSHOT, ACCOUNT_KIND);
+    max_users = txn_users_count(snap_users ? snap_users : DEFAULT_USERS);
 
     const char *filename = argv[1];
     srand(time(NULL));
@@ -191,8 +283,9 @@ int main(int argc, char *argv[]) {
     struct timespec start_time, end_time;
     clock_gettime(CLOCK_MONOTONIC, &start_time);
     
-    FILE *fp = fopen(filename, "r");
-    if (!fp) {
+    // 입력은 부모가 한 번만 파싱하고, 대출 자식은 TXN_QUEUES_FD 로 결과를 받는다
+    TxnQueues *q = txn_queues_build(filename);
+    if (!q) {
         perror("파일 열기 실패");
         return 1;
     }
@@ -202,6 +295,7 @@ int main(int argc, char *argv[]) {
         return 1;
     }
     else if (pid == 0) {
+        txn_queues_share(q);   // 대출 자식만 세그먼트를 물려받는다
         execl("./loanchild", "loanchild",  filename, NULL);
     	perror("exec 실패");  // exec 실패 시에만 실행됨
     	exit(1);
@@ -211,27 +305,44 @@ int main(int argc, char *argv[]) {
     init_account_db();
 
 
-    int type, amount, user, account, password, receiver, identifier;
-    while (fscanf(fp, "%d", &type) == 1) {
-        if (type == 1) {
-            fscanf(fp, "%d %d %d %d", &amount, &user, &account, &password);
-            atm_worker_line(amount, user, account, password);
-        } else if (type == 3) {
-            fscanf(fp, "%d %d %d %d %d", &amount, &user, &account, &password, &receiver);
-            mobile_app_transfer(amount, user, account, password, receiver);
-        } else {
-            char buf[256];
-            fgets(buf, sizeof(buf), fp);
+    build_account_index();
+
+    // 한 묶음의 계좌번호를 한꺼번에 색인에서 찾고 (버킷 선읽기), 찾은 계좌 칸과 수신자
+    // 잔액도 모두 선읽기한 뒤 파일 순서대로 처리한다 (bench_prefetch_window.c 의 "묶음")
+    TxnQueueIter it;
+    TxnRecord recs[TXN_ACCTMAP_BATCH];
+    uint64_t keys[TXN_ACCTMAP_BATCH];
+    uint32_t slots[TXN_ACCTMAP_BATCH];
+    size_t n;
+    txn_queue_iter_init(&it, q, (1u << TXN_ATM) | (1u << TXN_TRANSFER));
+    do {
+        for (n = 0; n < TXN_ACCTMAP_BATCH && txn_queue_iter_next(&it, &recs[n]); n++)
+            keys[n] = recs[n].account > 0 ? (uint64_t)recs[n].account : 0;
+        txn_acctmap_find_batch(&acct_index, keys, slots, n);
+        for (size_t i = 0; i < n; i++) {
+            txn_accounts_prefetch(&acc_db->accounts, slots[i]);
+            if (recs[i].type == TXN_TRANSFER && txn_user_valid(recs[i].receiver, max_users))
+                __builtin_prefetch(&acc_db->accounts.balance[recs[i].receiver], 1, 3);
         }
-    }
-
-    fclose(fp);
+        for (size_t i = 0; i < n; i++) {
+            TxnRecord *rec = &recs[i];
+            if (rec->type == TXN_ATM) {
+                atm_worker_line(rec->amount, rec->user, slots[i], rec->password);
+            } else if (rec->type == TXN_TRANSFER) {
+                mobile_app_transfer(rec->amount, rec->user, slots[i], rec->password, rec->receiver);
+            }
+        }
+    } while (n == TXN_ACCTMAP_BATCH);
+    txn_queues_release(q);
+    txn_acctmap_destroy(&acct_index);
+    txn_accounts_report(&acc_db->accounts, DEFAULT_BALANCE);
 
     clock_gettime(CLOCK_MONOTONIC, &end_time);
     double wall_sec = (end_time.tv_sec - start_time.tv_sec)
                     + (end_time.tv_nsec - start_time.tv_nsec) / 1e9;
 
     print_cpu_time();
+    txn_init_report(&init_stats, wall_sec);
     printf("⏱ 전체 실행 시간 (Wall-clock): %.6f 초\n\n", wall_sec);
 
     return 0;
@@ -4,26 +4,26 @@
 #include <math.h>
 #include <sys/resource.h>
 #include <time.h>
+#include "../txn_queues.h"
+#include "../txn_sparse.h"
+#include "../txn_users.h"
 
-#define MAX_USERS 5000000
+#define DEFAULT_USERS 5000000  // 실행 시 TXN_USERS 로 바꿀 수 있다
 #define NUM_ATMS 1
+#define DEFAULT_BALANCE 10000000
 
 // ---------- 구조체 정의 ----------
 
+// 사용자 i 의 계좌는 계좌번호 = 비밀번호 = i, 잔액 DEFAULT_BALANCE 가 기본값이다.
+// 잔액이 처음 바뀌는 사용자만 balances 에 만든다 (txn_sparse.h).
 typedef struct {
-    int user;
-    int account;
-    int password;
-    int card_balance;
-} AccountInfo;
-
-typedef struct {
-    AccountInfo *accounts;
+    TxnSparse balances;   // 사용자 번호 → 잔액
     int *atm_funds;
 } AccountDB;
 
 // ---------- 전역 포인터 변수 ----------
 
+size_t max_users;  // 실행 시 정한 사용자 수 (txn_users.h)
 AccountDB *acc_db;
 
 
@@ -37,19 +37,42 @@ void database_sim_load() {
 }
 // ---------- 초기화 ----------
 
+// 계좌를 처음 건드릴 때 불린다. 로딩 비용도 이때 그 사용자 몫만 치른다.
+void load_account(int user, void *val, void *ctx) {
+    (void)user;
+    (void)ctx;
+    database_sim_load();
+    *(int *)val = DEFAULT_BALANCE;
+}
+
 void init_account_db() {
     acc_db = malloc(sizeof(AccountDB));
-    acc_db->accounts = malloc(sizeof(AccountInfo) * (MAX_USERS + 1));
+    if (txn_sparse_init(&acc_db->balances, sizeof(int), load_account, NULL) < 0) {
+        perror("계좌 저장소 할당 실패");
+        exit(1);
+    }
     acc_db->atm_funds = malloc(sizeof(int) * NUM_ATMS);
     acc_db->atm_funds[0] = 10000000;
+}
+
+// 계좌번호와 비밀번호는 바뀌지 않으므로 저장하지 않고 사용자 번호와 비교한다.
+int account_auth(int user, int account, int password) {
+    return account == user && password == user;
+}
+
+// 실체화되지 않은 계좌는 기본 잔액이다. 읽기만 할 때는 계좌를 만들지 않는다.
+int current_balance(int user) {
+    const int *bal = txn_sparse_get(&acc_db->balances, user);
+    return bal ? *bal : DEFAULT_BALANCE;
+}
 
-    for (int i = 1; i <= MAX_USERS; i++) {
-    	database_sim_load();
-        acc_db->accounts[i].user = i;
-        acc_db->accounts[i].account = i;
-        acc_db->accounts[i].password = i;
-        acc_db->accounts[i].card_balance = 10000000;
+// 전체 잔액 합: 기본값 × 사용자 수 + 실체화된 계좌의 변동분
+long long total_balance() {
+    long long total = (long long)max_users * DEFAULT_BALANCE;
+    TXN_SPARSE_EACH(&acc_db->balances, int, user, bal) {
+        total += *bal - DEFAULT_BALANCE;
     }
+    return total;
 }
 
 // ---------- 로딩 시뮬레이션 ----------
@@ -107,47 +130,54 @@ void print_cpu_time() {
 // ---------- 기능 처리 함수 ----------
 
 void atm_worker_line(int amount, int user, int account, int password) {
-    if (user < 1 || user > MAX_USERS) {
+    if (!txn_user_valid(user, max_users)) {
         printf("ATM 처리 실패: 잘못된 사용자 번호 %d\n", user);
         return;
     }
 
     sim_load();
-    AccountInfo *info = &acc_db->accounts[user];
-
-    if (info->account != account || info->password != password) {
+    if (!account_auth(user, account, password)) {
         printf("ATM 인증 실패: 사용자 %d\n", user);
         return;
     }
 
-    int user_before = info->card_balance;
+    int user_before = current_balance(user);
     int atm_before = acc_db->atm_funds[0];
+    int withdraw = -amount;
+
+    // 잔액이 바뀌는 경우에만 계좌를 만든다
+    int *balance = NULL;
+    if (amount >= 0 || (withdraw <= user_before && withdraw <= atm_before)) {
+        balance = txn_sparse_touch(&acc_db->balances, user);
+        if (!balance) {
+            perror("계좌 저장소 확장 실패");
+            return;
+        }
+    }
 
     if (amount >= 0) {
         // 입금 처리
-        info->card_balance += amount;
+        *balance += amount;
         acc_db->atm_funds[0] += amount;
 
         printf("ATM 입금 성공: 사용자(%d번) | 금액: %d원\n", user, amount);
-        printf("사용자(%d번) 잔액: %d원 → %d원\n", user, user_before, info->card_balance);
+        printf("사용자(%d번) 잔액: %d원 → %d원\n", user, user_before, *balance);
         printf("ATM 자금: %d원 → %d원\n\n", atm_before, acc_db->atm_funds[0]);
     } else {
         // 출금 처리
-        int withdraw = -amount;
-
-        if (withdraw <= info->card_balance && withdraw <= acc_db->atm_funds[0]) {
+        if (balance) {
             // 출금 성공
-            info->card_balance -= withdraw;
+            *balance -= withdraw;
             acc_db->atm_funds[0] -= withdraw;
 
             printf("ATM 출금 성공: 사용자(%d번) | 금액: %d원\n", user, withdraw);
-            printf("사용자(%d번) 잔액: %d원 → %d원\n", user, user_before, info->card_balance);
+            printf("사용자(%d번) 잔액: %d원 → %d원\n", user, user_before, *balance);
             printf("ATM 자금: %d원 → %d원\n\n", atm_before, acc_db->atm_funds[0]);
         } else {
             // 출금 실패: 사유별 메시지
             printf("ATM 출금 실패: 사용자(%d번) | 요청: %d원\n", user, withdraw);
-            if (withdraw > info->card_balance) {
-                printf("사용자(%d번) 잔액 부족: 보유 %d원\n", user, info->card_balance);
+            if (withdraw > user_before) {
+                printf("사용자(%d번) 잔액 부족: 보유 %d원\n", user, user_before);
             }
             if (withdraw > acc_db->atm_funds[0]) {
                 printf("ATM 자금 부족: 기기 보유 %d원\n", acc_db->atm_funds[0]);
@@ -160,39 +190,46 @@ void atm_worker_line(int amount, int user, int account, int password) {
 
 
 void mobile_app_transfer(int amount, int name, int account, int password, int receiver) {
-    if (name < 1 || name > MAX_USERS || receiver < 1 || receiver > MAX_USERS) {
+    if (!txn_user_valid(name, max_users) || !txn_user_valid(receiver, max_users)) {
         printf("송금 실패: 잘못된 사용자 번호 (송금자 %d, 수신자 %d)\n", name, receiver);
         return;
     }
 
     sim_load();
-    AccountInfo *sender = &acc_db->accounts[name];
-    AccountInfo *recv   = &acc_db->accounts[receiver];
     int real_amount = abs(amount);
 
-    if (sender->account != account || sender->password != password) {
+    if (!account_auth(name, account, password)) {
         printf("모바일 송금 실패: 계좌번호 또는 비밀번호 불일치 (송금자 %d번)\n\n", name);
         return;
     }
 
-    if (sender->card_balance < real_amount) {
+    if (current_balance(name) < real_amount) {
         printf("모바일 송금 실패: 잔액 부족 (송금자 %d번, 필요: %d, 보유: %d)\n\n",
-               name, real_amount, sender->card_balance);
+               name, real_amount, current_balance(name));
+        return;
+    }
+
+    // 두 번째 touch 가 테이블을 키우면 앞 포인터가 옮겨지므로 둘 다 만든 뒤 다시 찾는다
+    if (!txn_sparse_touch(&acc_db->balances, receiver) ||
+        !txn_sparse_touch(&acc_db->balances, name)) {
+        perror("계좌 저장소 확장 실패");
         return;
     }
+    int *sender = txn_sparse_get(&acc_db->balances, name);
+    int *recv   = txn_sparse_get(&acc_db->balances, receiver);
 
     // 전 잔액 저장
-    int sender_before = sender->card_balance;
-    int receiver_before = recv->card_balance;
+    int sender_before = *sender;
+    int receiver_before = *recv;
 
     // 송금 수행
-    sender->card_balance -= real_amount;
-    recv->card_balance   += real_amount;
+    *sender -= real_amount;
+    *recv   += real_amount;
 
     // 출력
     printf("모바일 송금 성공: %d번 → %d번 | 금액: %d원\n", name, receiver, real_amount);
-    printf("송금자(%d번) 잔액: %d원 → %d원\n", name, sender_before, sender->card_balance);
-    printf("수신자(%d번) 잔액: %d원 → %d원\n\n", receiver, receiver_before, recv->card_balance);
+    printf("송금자(%d번) 잔액: %d원 → %d원\n", name, sender_before, *sender);
+    printf("수신자(%d번) 잔액: %d원 → %d원\n\n", receiver, receiver_before, *recv);
 }
 
 
@@ -200,9 +237,10 @@ void mobile_app_transfer(int amount, int name, int account, int password, int re
 
 int main(int argc, char *argv[]) {
     if (argc != 2) {
-        fprintf(stderr, "사용법: %s <입력파일>\n", argv[0]);
+        fprintf(stderr, "사용법: %s <입력파일|->\n", argv[0]);
         return 1;
     }
+    max_users = txn_users_count(DEFAULT_USERS);
 
     const char *filename = argv[1];
     srand(time(NULL));
@@ -210,8 +248,9 @@ int main(int argc, char *argv[]) {
     struct timespec start_time, end_time;
     clock_gettime(CLOCK_MONOTONIC, &start_time);
     
-    FILE *fp = fopen(filename, "r");
-    if (!fp) {
+    // 입력은 부모가 한 번만 파싱하고, 대출 자식은 TXN_QUEUES_FD 로 결과를 받는다
+    TxnQueues *q = txn_queues_build(filename);
+    if (!q) {
         perror("파일 열기 실패");
         return 1;
     }
@@ -230,21 +269,20 @@ int main(int argc, char *argv[]) {
     init_account_db();
 
 
-    int type, amount, user, account, password, receiver, identifier;
-    while (fscanf(fp, "%d", &type) == 1) {
-        if (type == 1) {
-            fscanf(fp, "%d %d %d %d", &amount, &user, &account, &password);
-            atm_worker_line(amount, user, account, password);
-        } else if (type == 3) {
-            fscanf(fp, "%d %d %d %d %d", &amount, &user, &account, &password, &receiver);
-            mobile_app_transfer(amount, user, account, password, receiver);
-        } else {
-            char buf[256];
-            fgets(buf, sizeof(buf), fp);
+    TxnQueueIter it;
+    TxnRecord rec;
+    txn_queue_iter_init(&it, q, (1u << TXN_ATM) | (1u << TXN_TRANSFER));
+    while (txn_queue_iter_next(&it, &rec)) {
+        if (rec.type == TXN_ATM) {
+            atm_worker_line(rec.amount, rec.user, rec.account, rec.password);
+        } else if (rec.type == TXN_TRANSFER) {
+            mobile_app_transfer(rec.amount, rec.user, rec.account, rec.password, rec.receiver);
         }
     }
     print_memory_usage("👶 이전 부모 프로세스");
-    fclose(fp);
+    txn_queues_release(q);
+    txn_sparse_report(&acc_db->balances, "계좌", max_users);
+    printf("💰 잔액 합계 %lld원\n", total_balance());
 
     clock_gettime(CLOCK_MONOTONIC, &end_time);
     double wall_sec = (end_time.tv_sec - start_time.tv_sec)
@@ -4,25 +4,30 @@
 #include <math.h>
 #include <sys/resource.h>
 #include <time.h>
+#include "../txn_queues.h"
+#include "../txn_sparse.h"
+#include "../txn_users.h"
 
-#define MAX_USERS 5000000
+#define DEFAULT_USERS 5000000  // 실행 시 TXN_USERS 로 바꿀 수 있다
 
 // ---------- 구조체 정의 ----------
 
+// 사용자 i 의 기본값은 식별번호 i, 부채 0, 등급은 (시드, i) 에서 뽑은 1~5 다.
+// 대출로 부채가 생기는 사용자만 users 에 만든다 (txn_sparse.h).
 typedef struct {
-    int user;
-    int identifier;
     int debt;
     int credit_rank;
 } UserInfo;
 
 typedef struct {
-    UserInfo *users;
+    TxnSparse users;      // 사용자 번호 → UserInfo
+    uint32_t rank_seed;
     int bank_funds;
 } UserDB;
 
 // ---------- 전역 포인터 변수 ----------
 
+size_t max_users;  // 실행 시 정한 사용자 수 (txn_users.h)
 UserDB *loan_db;
 
 // ---------- 로딩 시뮬레이션 ----------
@@ -35,18 +40,29 @@ void database_sim_load() {
 }
 // ---------- 초기화 ----------
 
+// 등급은 실행마다 무작위지만 한 실행 안에서는 사용자마다 고정이어야 하므로
+// rand() 순서 대신 시드와 사용자 번호로 정한다.
+int default_credit_rank(int user) {
+    return (int)(txn_sparse_mix(loan_db->rank_seed ^ (uint32_t)user) % 5) + 1;
+}
+
+// 사용자를 처음 건드릴 때 불린다. 로딩 비용도 이때 그 사용자 몫만 치른다.
+void load_user(int user, void *val, void *ctx) {
+    (void)ctx;
+    database_sim_load();
+    UserInfo *info = val;
+    info->debt = 0;
+    info->credit_rank = default_credit_rank(user);
+}
+
 void init_user_db() {
     loan_db = malloc(sizeof(UserDB));
-    loan_db->users = malloc(sizeof(UserInfo) * (MAX_USERS + 1));
-    loan_db->bank_funds = 2000000000;
-
-    for (int i = 1; i <= MAX_USERS; i++) {
-    	database_sim_load();
-        loan_db->users[i].user = i;
-        loan_db->users[i].identifier = i;
-        loan_db->users[i].debt = 0;
-        loan_db->users[i].credit_rank = (rand() % 5) + 1;
+    if (txn_sparse_init(&loan_db->users, sizeof(UserInfo), load_user, NULL) < 0) {
+        perror("사용자 저장소 할당 실패");
+        exit(1);
     }
+    loan_db->rank_seed = (uint32_t)rand();
+    loan_db->bank_funds = 2000000000;
 }
 
 // ---------- 로딩 시뮬레이션 ----------
@@ -114,20 +130,21 @@ void print_memory_usage(const char *label) {
 // ---------- 기능 처리 함수 ----------
 
 void handle_single_loan(int user, int amount, int identifier) {
-    if (user < 1 || user > MAX_USERS) {
+    if (!txn_user_valid(user, max_users)) {
         printf("대출 실패: 잘못된 사용자 번호 %d\n", user);
         return;
     }
 
     loan_sim_load();
-    UserInfo *info = &loan_db->users[user];
-
-    if (info->identifier != identifier) {
+    // 식별번호는 바뀌지 않으므로 저장하지 않고 사용자 번호와 비교한다
+    if (identifier != user) {
         printf("대출 실패: 사용자 인증 실패 (%d번)\n", user);
         return;
     }
 
-    int credit = info->credit_rank;
+    // 읽기만 할 때는 만들지 않고 기본값을 쓴다
+    UserInfo *info = txn_sparse_get(&loan_db->users, user);
+    int credit = info ? info->credit_rank : default_credit_rank(user);
     int max_loan = 0;
 
     switch (credit) {
@@ -149,13 +166,18 @@ void handle_single_loan(int user, int amount, int identifier) {
         amount = max_loan;
     }
 
-    int user_debt_before = info->debt;
+    int user_debt_before = info ? info->debt : 0;
     int bank_before = loan_db->bank_funds;
 
     printf("대출 요청: 사용자 %d | 등급 %d | 최종 대출 금액: %d원\n",
            user, credit, amount);
 
     if (loan_db->bank_funds >= amount) {
+        info = txn_sparse_touch(&loan_db->users, user);
+        if (!info) {
+            perror("사용자 저장소 확장 실패");
+            return;
+        }
         info->debt += amount;
         loan_db->bank_funds -= amount;
         printf("대출 승인\n");
@@ -173,9 +195,10 @@ void handle_single_loan(int user, int amount, int identifier) {
 
 int main(int argc, char *argv[]) {
     if (argc != 2) {
-        fprintf(stderr, "사용법: %s <입력파일>\n", argv[0]);
+        fprintf(stderr, "사용법: %s <입력파일|->\n", argv[0]);
         return 1;
     }
+    max_users = txn_users_count(DEFAULT_USERS);
 
     const char *filename = argv[1];
     srand(time(NULL));
@@ -183,27 +206,24 @@ int main(int argc, char *argv[]) {
     struct timespec start_time, end_time;
     clock_gettime(CLOCK_MONOTONIC, &start_time);
 
-    FILE *fp = fopen(filename, "r");
-    if (!fp) {
+    // 부모가 넘긴 대출 배열을 그대로 쓴다 (없으면 색인으로 대출 줄만 파싱)
+    TxnQueues *q = txn_queues_load(filename, 1u << TXN_LOAN);
+    if (!q) {
         perror("파일 열기 실패");
         return 1;
     }
 
     init_user_db();
 
-    int type, amount, user, account, password, receiver, identifier;
-    while (fscanf(fp, "%d", &type) == 1) {
-        if (type == 2) {
-            fscanf(fp, "%d %d %d", &amount, &user, &identifier);
-            handle_single_loan(user, amount, identifier);
-        } else {
-            char buf[256];
-            fgets(buf, sizeof(buf), fp);
-        }
+    size_t loan_n;
+    const TxnRecord *loans = txn_queue(q, TXN_LOAN, &loan_n);
+    for (size_t i = 0; i < loan_n; i++) {
+        handle_single_loan(loans[i].user, loans[i].amount, txn_identifier(&loans[i]));
     }
     print_memory_usage("👶이전 자식 프로세스 ");
+    txn_sparse_report(&loan_db->users, "대출 사용자", max_users);
 
-    fclose(fp);
+    txn_queues_release(q);
 
     clock_gettime(CLOCK_MONOTONIC, &end_time);
     double wall_sec = (end_time.tv_sec - start_time.tv_sec)
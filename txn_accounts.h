@@ -0,0 +1,156 @@
+// txn_accounts.h
+// 열(column) 단위 계좌 저장소 (AccountInfo 배열 대신)
+//
+// AccountInfo { user, account, password, card_balance } 배열은 잔액 하나를 바꿀 때도
+// 16바이트 전체를 캐시로 끌어온다. 여기서는 자주 바뀌는 잔액, 인증에만 쓰는 계좌번호/
+// 비밀번호, 거의 안 보는 메타데이터를 따로 연속 배열로 둔다.
+//
+//   balance[] : ATM/송금이 읽고 쓰는 뜨거운 열 (64바이트 캐시 줄에 16명)
+//   cred[]    : 인증할 때만 읽는다. 계좌번호와 비밀번호는 항상 함께 보므로 한 쌍으로 둔다
+//   user[]    : 보고용 메타데이터
+//
+// 잔액 합계 같은 훑기는 balance[] 만 순서대로 읽으므로 벡터화된다.
+// 사용자 번호는 1..n 이고 0 번 칸은 비워 둔다 (기존 accounts[MAX_USERS + 1] 과 같다).
+//
+//   TxnAccounts acc;
+//   if (txn_accounts_create(&acc, max_users) < 0) { ... }
+//   if (txn_accounts_auth(&acc, user, account, password)) acc.balance[user] += amount;
+//   printf("%lld\n", txn_accounts_total(&acc));
+
+#ifndef TXN_ACCOUNTS_H
+#define TXN_ACCOUNTS_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include "txn_huge.h"
+
+#define TXN_ACCOUNTS_ALIGN 64  // 열마다 캐시 줄 경계에서 시작한다
+
+typedef struct {
+    int account;
+    int password;
+} TxnCred;
+
+typedef struct {
+    size_t n;          // 사용자 수 (번호 1..n)
+    int *balance;      // 뜨거운 열
+    TxnCred *cred;     // 인증 열
+    int *user;         // 차가운 열
+    void *base;        // 세 열을 담은 매핑 하나
+    size_t bytes;
+    TxnHuge huge;      // create 로 잡았을 때의 페이지 종류 (attach 면 base == NULL)
+} TxnAccounts;
+
+static inline size_t txn_accounts_col(size_t bytes) {
+    return (bytes + TXN_ACCOUNTS_ALIGN - 1) & ~(size_t)(TXN_ACCOUNTS_ALIGN - 1);
+}
+
+// 열 배치: [balance][cred][user], 각 열은 캐시 줄 경계에서 시작한다. 전체 바이트 수.
+static inline size_t txn_accounts_layout(size_t n, size_t *b_bytes, size_t *c_bytes) {
+    size_t slots = n + 1;
+    *b_bytes = txn_accounts_col(slots * sizeof(int));
+    *c_bytes = txn_accounts_col(slots * sizeof(TxnCred));
+    return *b_bytes + *c_bytes + txn_accounts_col(slots * sizeof(int));
+}
+
+// cols 에 txn_accounts_layout 배치로 놓인 열을 가리킨다. base/bytes 는 destroy 가 풀 매핑.
+static inline void txn_accounts_attach(TxnAccounts *a, size_t n, void *cols, void *base,
+                                       size_t bytes) {
+    size_t b_bytes, c_bytes;
+    txn_accounts_layout(n, &b_bytes, &c_bytes);
+    char *p = cols;
+    a->n = n;
+    a->base = base;
+    a->bytes = bytes;
+    memset(&a->huge, 0, sizeof(a->huge));
+    a->balance = (int *)p;
+    a->cred = (TxnCred *)(p + b_bytes);
+    a->user = (int *)(p + b_bytes + c_bytes);
+}
+
+// n 명 분의 열을 한 매핑에 잡는다. 가능하면 2MB 페이지를 쓴다 (txn_huge.h).
+// 내용은 0 이고 페이지는 아직 붙지 않았다. 실패 시 -1 (errno = ENOMEM).
+static inline int txn_accounts_create(TxnAccounts *a, size_t n) {
+    size_t b_bytes, c_bytes;
+    size_t bytes = txn_accounts_layout(n, &b_bytes, &c_bytes);
+    TxnHuge h;
+    void *p = txn_huge_alloc(&h, bytes);
+    if (!p)
+        return -1;
+    txn_accounts_attach(a, n, p, p, h.bytes);
+    a->huge = h;
+    return 0;
+}
+
+static inline void txn_accounts_destroy(TxnAccounts *a) {
+    if (a->base)
+        munmap(a->base, a->bytes);
+    a->base = NULL;
+}
+
+static inline int txn_accounts_valid(const TxnAccounts *a, int user) {
+    return user >= 1 && (size_t)user <= a->n;
+}
+
+// 인증 열만 읽는다. user 범위는 호출자가 먼저 확인한다.
+static inline int txn_accounts_auth(const TxnAccounts *a, int user, int account, int password) {
+    const TxnCred *c = &a->cred[user];
+    return c->account == account && c->password == password;
+}
+
+// 계좌번호 색인(txn_acctmap.h)으로 찾은 칸으로 인증한다.
+// 그 칸이 user 의 계좌이고 비밀번호가 맞아야 한다. 못 찾은 칸(범위 밖)은 실패.
+static inline int txn_accounts_auth_slot(const TxnAccounts *a, uint32_t slot, int user,
+                                         int password) {
+    return slot >= 1 && slot <= a->n && a->user[slot] == user && a->cred[slot].password == password;
+}
+
+// 곧 처리할 칸의 세 열(인증에 읽는 cred/user, 쓰는 balance)을 미리 읽어 둔다.
+// 여러 칸을 먼저 다 부른 뒤 처리하면 캐시 미스가 겹쳐서 기다린다. 범위 밖 칸은 건너뛴다.
+static inline void txn_accounts_prefetch(const TxnAccounts *a, uint32_t slot) {
+    if (slot < 1 || slot > a->n)
+        return;
+    __builtin_prefetch(&a->cred[slot], 0, 3);
+    __builtin_prefetch(&a->user[slot], 0, 3);
+    __builtin_prefetch(&a->balance[slot], 1, 3);
+}
+
+// ---------- 훑기 (잔액 열만) ----------
+
+// 전체 잔액 합. 64비트로 더하므로 사용자가 많아도 넘치지 않는다.
+static inline long long txn_accounts_total(const TxnAccounts *a) {
+    const int *restrict b = a->balance + 1;
+    size_t n = a->n;
+    // 독립된 누산기 여러 개로 나눠 의존 사슬을 끊고 벡터화를 돕는다
+    int64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        s0 += b[i];
+        s1 += b[i + 1];
+        s2 += b[i + 2];
+        s3 += b[i + 3];
+    }
+    for (; i < n; i++)
+        s0 += b[i];
+    return (long long)(s0 + s1 + s2 + s3);
+}
+
+// 잔액이 floor 미만인 사용자 수
+static inline size_t txn_accounts_count_below(const TxnAccounts *a, int floor) {
+    const int *restrict b = a->balance + 1;
+    size_t cnt = 0;
+    for (size_t i = 0; i < a->n; i++)
+        cnt += b[i] < floor;
+    return cnt;
+}
+
+static inline void txn_accounts_report(const TxnAccounts *a, int floor) {
+    printf("💰 계좌 %zu개 | 잔액 합계 %lld원 | %d원 미만 %zu개 | 열 저장소 %.1f MB\n",
+           a->n, txn_accounts_total(a), floor, txn_accounts_count_below(a, floor),
+           a->bytes / (1024.0 * 1024.0));
+}
+
+#endif
@@ -0,0 +1,191 @@
+// txn_acctmap.h
+// 계좌번호 → 계좌 칸 색인 (열린 주소법, SIMD 탐색, 일괄 선읽기)
+//
+// 처리기는 accounts[user] 를 보고 계좌번호를 비교했는데, 이는 초기화 때
+// 계좌번호 == 사용자 번호 라서만 맞았다. 실제 계좌번호는 10~14자리의 듬성한 값이므로
+// 계좌번호로 칸을 찾는 색인을 둔다. 키는 64비트라 14자리 번호도 담는다.
+//
+// 버킷 하나는 64비트 키 8개 = 캐시 라인 하나다. 해시로 고른 버킷의 키 8개를 SSE2 로
+// 한꺼번에 비교하고, 없고 빈 칸도 없으면 다음 버킷으로 간다 (선형 탐색). 칸 번호는
+// 따로 된 slots[] 의 같은 자리에 있어 찾았을 때만 읽는다. 적재율은 80% 이하로 둔다.
+//
+//   TxnAcctMap m;
+//   txn_acctmap_create(&m, n);
+//   txn_acctmap_insert(&m, account, slot);
+//   uint32_t slot = txn_acctmap_find(&m, account);   // 없으면 TXN_ACCTMAP_NONE
+//
+// 여러 건을 한꺼번에 찾을 때는 txn_acctmap_find_batch() 가 먼저 모든 버킷(키 라인과
+// 칸 라인)을 선읽기한 뒤 탐색하므로, 캐시 미스 대기가 건마다가 아니라 묶음마다 한 번이다.
+// 계좌번호 0 은 빈 칸 표시라 쓸 수 없다.
+
+#ifndef TXN_ACCTMAP_H
+#define TXN_ACCTMAP_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "txn_huge.h"
+
+#define TXN_ACCTMAP_WAYS  8            // 버킷당 키 수 (캐시 라인 하나)
+#define TXN_ACCTMAP_BATCH 16           // find_batch 가 한 번에 선읽기하는 건수
+#define TXN_ACCTMAP_NONE  UINT32_MAX
+
+typedef struct {
+    _Alignas(64) uint64_t key[TXN_ACCTMAP_WAYS];   // 0 = 빈 칸
+} TxnAcctBucket;
+
+typedef struct {
+    TxnAcctBucket *keys;
+    uint32_t *slots;       // 버킷 b 의 칸 번호는 slots[b * WAYS ...]
+    size_t buckets;
+    size_t count;
+    size_t max_probe;      // 가장 긴 탐색 (버킷 수)
+    TxnHuge huge;          // keys 와 slots 를 담은 매핑
+    double build_sec;      // 호출자가 채운다 (보고용)
+} TxnAcctMap;
+
+static inline uint64_t txn_acctmap_hash(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+// 나눗셈 없이 [0, buckets) 로 줄인다
+static inline size_t txn_acctmap_home(const TxnAcctMap *m, uint64_t key) {
+    return (size_t)(((unsigned __int128)txn_acctmap_hash(key) * m->buckets) >> 64);
+}
+
+// 버킷에서 key 와 같은 칸의 비트마스크 (비트 i = key[i] == key)
+static inline unsigned txn_acctmap_match(const TxnAcctBucket *b, uint64_t key) {
+#ifdef __SSE2__
+    // SSE2 에는 64비트 비교가 없으므로 32비트 반쪽을 비교해 두 반쪽이 다 같은 칸만 남긴다
+    __m128i k = _mm_set1_epi64x((long long)key);
+    unsigned mask = 0;
+    for (int i = 0; i < TXN_ACCTMAP_WAYS / 2; i++) {
+        __m128i e = _mm_cmpeq_epi32(_mm_load_si128((const __m128i *)b->key + i), k);
+        e = _mm_and_si128(e, _mm_shuffle_epi32(e, _MM_SHUFFLE(2, 3, 0, 1)));
+        mask |= (unsigned)_mm_movemask_pd(_mm_castsi128_pd(e)) << (2 * i);
+    }
+    return mask;
+#else
+    unsigned mask = 0;
+    for (int i = 0; i < TXN_ACCTMAP_WAYS; i++)
+        mask |= (unsigned)(b->key[i] == key) << i;
+    return mask;
+#endif
+}
+
+// n 개를 담을 색인을 잡는다. 실패 시 -1 (errno = ENOMEM).
+static inline int txn_acctmap_create(TxnAcctMap *m, size_t n) {
+    memset(m, 0, sizeof(*m));
+    // 적재율 80%: 버킷 수 = n / (8 × 0.8) 올림
+    m->buckets = (n * 5 + TXN_ACCTMAP_WAYS * 4 - 1) / (TXN_ACCTMAP_WAYS * 4);
+    if (m->buckets < 1)
+        m->buckets = 1;
+    size_t key_bytes = m->buckets * sizeof(TxnAcctBucket);
+    size_t slot_bytes = m->buckets * TXN_ACCTMAP_WAYS * sizeof(uint32_t);
+    char *p = txn_huge_alloc(&m->huge, key_bytes + slot_bytes);
+    if (!p)
+        return -1;
+    m->keys = (TxnAcctBucket *)p;
+    m->slots = (uint32_t *)(p + key_bytes);
+    return 0;
+}
+
+static inline void txn_acctmap_destroy(TxnAcctMap *m) {
+    txn_huge_free(&m->huge);
+    m->keys = NULL;
+    m->slots = NULL;
+}
+
+// 곧 넣거나 찾을 key 의 home 버킷을 미리 읽어 둔다 (구축 루프에서 몇 건 앞서 부른다)
+static inline void txn_acctmap_prefetch(const TxnAcctMap *m, uint64_t key) {
+    size_t b = txn_acctmap_home(m, key);
+    __builtin_prefetch(&m->keys[b], 1, 3);
+    __builtin_prefetch(&m->slots[b * TXN_ACCTMAP_WAYS], 1, 3);
+}
+
+// 실패 시 -1: 계좌번호 0 이거나 중복 (EINVAL / EEXIST), 가득 참 (ENOSPC).
+static inline int txn_acctmap_insert(TxnAcctMap *m, uint64_t key, uint32_t slot) {
+    if (key == 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    size_t b = txn_acctmap_home(m, key);
+    for (size_t probe = 1; probe <= m->buckets; probe++) {
+        TxnAcctBucket *bk = &m->keys[b];
+        if (txn_acctmap_match(bk, key)) {
+            errno = EEXIST;
+            return -1;
+        }
+        unsigned empty = txn_acctmap_match(bk, 0);
+        if (empty) {
+            int i = __builtin_ctz(empty);
+            bk->key[i] = key;
+            m->slots[b * TXN_ACCTMAP_WAYS + i] = slot;
+            m->count++;
+            if (probe > m->max_probe)
+                m->max_probe = probe;
+            return 0;
+        }
+        if (++b == m->buckets)
+            b = 0;
+    }
+    errno = ENOSPC;
+    return -1;
+}
+
+// home 버킷부터 찾는다. 지우기가 없으므로 빈 칸이 있는 버킷에서 멈춰도 된다.
+static inline uint32_t txn_acctmap_find_from(const TxnAcctMap *m, uint64_t key, size_t b) {
+    if (key == 0)
+        return TXN_ACCTMAP_NONE;
+    for (size_t probe = 0; probe < m->max_probe; probe++) {
+        const TxnAcctBucket *bk = &m->keys[b];
+        unsigned hit = txn_acctmap_match(bk, key);
+        if (hit)
+            return m->slots[b * TXN_ACCTMAP_WAYS + __builtin_ctz(hit)];
+        if (txn_acctmap_match(bk, 0))
+            break;
+        if (++b == m->buckets)
+            b = 0;
+    }
+    return TXN_ACCTMAP_NONE;
+}
+
+static inline uint32_t txn_acctmap_find(const TxnAcctMap *m, uint64_t key) {
+    return txn_acctmap_find_from(m, key, txn_acctmap_home(m, key));
+}
+
+// keys[i] 의 칸을 out[i] 에 (없으면 TXN_ACCTMAP_NONE). TXN_ACCTMAP_BATCH 건씩
+// 모든 home 버킷의 키 라인과 칸 라인을 먼저 선읽기한 뒤 차례로 탐색한다.
+static inline void txn_acctmap_find_batch(const TxnAcctMap *m, const uint64_t *keys, uint32_t *out,
+                                          size_t n) {
+    size_t home[TXN_ACCTMAP_BATCH];
+    for (size_t base = 0; base < n; base += TXN_ACCTMAP_BATCH) {
+        size_t k = n - base < TXN_ACCTMAP_BATCH ? n - base : TXN_ACCTMAP_BATCH;
+        for (size_t j = 0; j < k; j++) {
+            home[j] = txn_acctmap_home(m, keys[base + j]);
+            __builtin_prefetch(&m->keys[home[j]], 0, 3);
+            __builtin_prefetch(&m->slots[home[j] * TXN_ACCTMAP_WAYS], 0, 3);
+        }
+        for (size_t j = 0; j < k; j++)
+            out[base + j] = txn_acctmap_find_from(m, keys[base + j], home[j]);
+    }
+}
+
+static inline void txn_acctmap_report(const TxnAcctMap *m, const char *label) {
+    printf("🔎 %s 색인: %zu개 | 버킷 %zu개 × %d칸 | 적재율 %.1f%% | 최장 탐색 %zu버킷 | "
+           "%.1f MB (%s) | 구축 %.6f 초\n",
+           label, m->count, m->buckets, TXN_ACCTMAP_WAYS,
+           100.0 * m->count / (m->buckets * TXN_ACCTMAP_WAYS), m->max_probe,
+           m->huge.bytes / (1024.0 * 1024.0), txn_huge_name(m->huge.kind), m->build_sec);
+}
+
+#endif
@@ -0,0 +1,435 @@
+// txn_aio.h
+// 큰 입력 파일을 위한 비동기 선읽기 (io_uring, 안 되면 선읽기 스레드)
+//
+// 파일을 TXN_AIO_CHUNK 크기 조각으로 나눠 TXN_AIO_DEPTH 개를 항상 읽는 중으로 둔다.
+// 소비자는 txn_aio_read() 로 read() 처럼 파일 순서대로 바이트를 받아 가고, 조각 하나를
+// 다 쓰면 그 버퍼로 depth 만큼 뒤의 조각을 바로 다시 요청한다. 디스크 대기는 소비자가
+// 앞 조각을 파싱하고 거래를 실행하는 동안 뒤에서 일어난다.
+//
+// io_uring 은 liburing 없이 시스템 콜을 직접 부른다. 커널이 지원하지 않거나 막혀 있으면
+// (ENOSYS, EPERM 등) pread 를 도는 선읽기 스레드로 같은 일을 한다.
+//
+// txn_reader 가 일반 파일에서 이 백엔드를 쓰는 조건은 txn_aio_wanted() 참고.
+
+#ifndef TXN_AIO_H
+#define TXN_AIO_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+#ifndef TXN_AIO_DEPTH
+#define TXN_AIO_DEPTH     4                  // 동시에 읽는 조각 수
+#endif
+#ifndef TXN_AIO_CHUNK
+#define TXN_AIO_CHUNK     (2 << 20)          // 조각 크기 (바이트)
+#endif
+#define TXN_AIO_MIN_FILE  (64ULL << 20)      // 자동 모드에서 고려하는 최소 파일 크기
+#define TXN_AIO_ENV       "TXN_READAHEAD"    // off | auto | uring | thread
+
+#define TXN_AIO_NONE   0
+#define TXN_AIO_URING  1
+#define TXN_AIO_THREAD 2
+
+enum { TXN_SLOT_FREE, TXN_SLOT_BUSY, TXN_SLOT_DONE };
+
+typedef struct {
+    size_t off, len;
+    ssize_t res;
+    int state;
+} TxnAioSlot;
+
+typedef struct {
+    int ring_fd;
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sq_ptr, *cq_ptr;
+    size_t sq_bytes, cq_bytes, sqes_bytes;
+} TxnUring;
+
+typedef struct {
+    int fd;
+    size_t size;
+    int backend;
+    char *bufs;                     // TXN_AIO_DEPTH * TXN_AIO_CHUNK
+    TxnAioSlot slot[TXN_AIO_DEPTH];
+    size_t cur;                     // 소비 중인 조각 번호
+    size_t cur_pos;                 // 그 조각에서 이미 넘긴 바이트
+    int have;                       // cur 조각을 받아 둔 상태
+    unsigned long long wait_ns;     // 소비자가 I/O 를 기다린 시간
+    TxnUring ring;
+    pthread_t tid;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int stop;
+} TxnAio;
+
+static inline unsigned long long txn_aio_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static inline const char *txn_aio_backend_name(int backend) {
+    return backend == TXN_AIO_URING ? "io_uring" : backend == TXN_AIO_THREAD ? "선읽기 스레드" : "없음";
+}
+
+// 조각 c 의 파일 위치와 길이를 slot 에 적는다. 파일 끝을 넘으면 0.
+static inline int txn_aio_place(TxnAio *a, size_t c, TxnAioSlot *s) {
+    size_t off = c * (size_t)TXN_AIO_CHUNK;
+    if (off >= a->size)
+        return 0;
+    s->off = off;
+    s->len = a->size - off < TXN_AIO_CHUNK ? a->size - off : TXN_AIO_CHUNK;
+    s->res = 0;
+    return 1;
+}
+
+static inline char *txn_aio_buf(TxnAio *a, size_t c) {
+    return a->bufs + (c % TXN_AIO_DEPTH) * (size_t)TXN_AIO_CHUNK;
+}
+
+// ---------- io_uring ----------
+
+#ifdef __NR_io_uring_setup
+
+static inline int txn_uring_setup(TxnUring *r, unsigned entries) {
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    r->ring_fd = (int)syscall(__NR_io_uring_setup, entries, &p);
+    if (r->ring_fd < 0)
+        return -1;
+
+    r->sq_bytes = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    r->cq_bytes = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        if (r->cq_bytes > r->sq_bytes)
+            r->sq_bytes = r->cq_bytes;
+        r->cq_bytes = r->sq_bytes;
+    }
+    r->sq_ptr = mmap(NULL, r->sq_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     r->ring_fd, IORING_OFF_SQ_RING);
+    if (r->sq_ptr == MAP_FAILED)
+        goto fail;
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        r->cq_ptr = r->sq_ptr;
+    } else {
+        r->cq_ptr = mmap(NULL, r->cq_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         r->ring_fd, IORING_OFF_CQ_RING);
+        if (r->cq_ptr == MAP_FAILED) {
+            munmap(r->sq_ptr, r->sq_bytes);
+            goto fail;
+        }
+    }
+    r->sqes_bytes = p.sq_entries * sizeof(struct io_uring_sqe);
+    r->sqes = mmap(NULL, r->sqes_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   r->ring_fd, IORING_OFF_SQES);
+    if (r->sqes == MAP_FAILED) {
+        if (r->cq_ptr != r->sq_ptr)
+            munmap(r->cq_ptr, r->cq_bytes);
+        munmap(r->sq_ptr, r->sq_bytes);
+        goto fail;
+    }
+
+    char *sq = r->sq_ptr, *cq = r->cq_ptr;
+    r->sq_head = (unsigned *)(sq + p.sq_off.head);
+    r->sq_tail = (unsigned *)(sq + p.sq_off.tail);
+    r->sq_mask = (unsigned *)(sq + p.sq_off.ring_mask);
+    r->sq_array = (unsigned *)(sq + p.sq_off.array);
+    r->cq_head = (unsigned *)(cq + p.cq_off.head);
+    r->cq_tail = (unsigned *)(cq + p.cq_off.tail);
+    r->cq_mask = (unsigned *)(cq + p.cq_off.ring_mask);
+    r->cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+    return 0;
+
+fail:
+    close(r->ring_fd);
+    r->ring_fd = -1;
+    return -1;
+}
+
+static inline int txn_uring_submit_read(TxnAio *a, size_t c) {
+    TxnAioSlot *s = &a->slot[c % TXN_AIO_DEPTH];
+    if (!txn_aio_place(a, c, s))
+        return 0;
+
+    TxnUring *r = &a->ring;
+    unsigned tail = *r->sq_tail;
+    unsigned idx = tail & *r->sq_mask;
+    struct io_uring_sqe *sqe = &r->sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = a->fd;
+    sqe->addr = (unsigned long long)(uintptr_t)txn_aio_buf(a, c);
+    sqe->len = (unsigned)s->len;
+    sqe->off = s->off;
+    sqe->user_data = c % TXN_AIO_DEPTH;
+    r->sq_array[idx] = idx;
+    __atomic_store_n(r->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    s->state = TXN_SLOT_BUSY;
+
+    while (syscall(__NR_io_uring_enter, r->ring_fd, 1, 0, 0, NULL, 0) < 0) {
+        if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            // 소비자가 이 조각에서 오류를 보게 한다
+            s->res = -errno;
+            s->state = TXN_SLOT_DONE;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// 완료 큐를 비우며 slot 상태를 갱신한다. want 슬롯이 끝날 때까지 기다린다.
+static inline int txn_uring_wait(TxnAio *a, int want) {
+    TxnUring *r = &a->ring;
+    for (;;) {
+        unsigned head = *r->cq_head;
+        unsigned tail = __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE);
+        while (head != tail) {
+            struct io_uring_cqe *cqe = &r->cqes[head & *r->cq_mask];
+            TxnAioSlot *s = &a->slot[cqe->user_data];
+            s->res = cqe->res;
+            s->state = TXN_SLOT_DONE;
+            head++;
+        }
+        __atomic_store_n(r->cq_head, head, __ATOMIC_RELEASE);
+        if (want < 0 || a->slot[want].state == TXN_SLOT_DONE)
+            return 0;
+        if (syscall(__NR_io_uring_enter, r->ring_fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0 &&
+            errno != EINTR)
+            return -1;
+    }
+}
+
+static inline void txn_uring_close(TxnAio *a) {
+    TxnUring *r = &a->ring;
+    // 버퍼를 풀기 전에 날아가 있는 요청을 모두 거둔다
+    for (int i = 0; i < TXN_AIO_DEPTH; i++) {
+        if (a->slot[i].state == TXN_SLOT_BUSY && txn_uring_wait(a, i) < 0)
+            break;
+    }
+    munmap(r->sqes, r->sqes_bytes);
+    if (r->cq_ptr != r->sq_ptr)
+        munmap(r->cq_ptr, r->cq_bytes);
+    munmap(r->sq_ptr, r->sq_bytes);
+    close(r->ring_fd);
+}
+
+#else
+
+static inline int txn_uring_setup(TxnUring *r, unsigned entries) {
+    (void)entries;
+    r->ring_fd = -1;
+    errno = ENOSYS;
+    return -1;
+}
+static inline int txn_uring_submit_read(TxnAio *a, size_t c) {
+    (void)a; (void)c; errno = ENOSYS; return -1;
+}
+static inline int txn_uring_wait(TxnAio *a, int want) {
+    (void)a; (void)want; errno = ENOSYS; return -1;
+}
+static inline void txn_uring_close(TxnAio *a) { (void)a; }
+
+#endif
+
+// ---------- 선읽기 스레드 ----------
+
+static inline ssize_t txn_aio_pread_full(int fd, char *buf, size_t len, size_t off) {
+    size_t got = 0;
+    while (got < len) {
+        ssize_t r = pread(fd, buf + got, len - got, (off_t)(off + got));
+        if (r < 0 && errno == EINTR)
+            continue;
+        if (r < 0)
+            return got ? (ssize_t)got : -errno;
+        if (r == 0)
+            break;
+        got += (size_t)r;
+    }
+    return (ssize_t)got;
+}
+
+static inline void *txn_aio_prefetcher(void *arg) {
+    TxnAio *a = arg;
+    for (size_t c = 0;; c++) {
+        TxnAioSlot *s = &a->slot[c % TXN_AIO_DEPTH];
+        pthread_mutex_lock(&a->lock);
+        while (s->state != TXN_SLOT_FREE && !a->stop)
+            pthread_cond_wait(&a->cond, &a->lock);
+        int go = !a->stop && txn_aio_place(a, c, s);
+        if (go)
+            s->state = TXN_SLOT_BUSY;
+        pthread_mutex_unlock(&a->lock);
+        if (!go)
+            return NULL;
+
+        ssize_t r = txn_aio_pread_full(a->fd, txn_aio_buf(a, c), s->len, s->off);
+
+        pthread_mutex_lock(&a->lock);
+        s->res = r;
+        s->state = TXN_SLOT_DONE;
+        pthread_cond_broadcast(&a->cond);
+        pthread_mutex_unlock(&a->lock);
+    }
+}
+
+// ---------- 공통 ----------
+
+// 환경변수와 파일 상태로 백엔드를 고른다. resident 는 페이지 캐시에 올라와 있는 비율(0~1).
+static inline int txn_aio_wanted(size_t size, double resident) {
+    const char *env = getenv(TXN_AIO_ENV);
+    if (env && strcmp(env, "off") == 0)
+        return TXN_AIO_NONE;
+    if (env && strcmp(env, "thread") == 0)
+        return TXN_AIO_THREAD;
+    if (env && strcmp(env, "uring") == 0)
+        return TXN_AIO_URING;
+    // 자동: 캐시에 대부분 없는 큰 파일만 (캐시에 있으면 mmap + 병렬 파싱이 낫다)
+    if (size >= TXN_AIO_MIN_FILE && resident < 0.5)
+        return TXN_AIO_URING;
+    return TXN_AIO_NONE;
+}
+
+// backend 로 열되, io_uring 이 안 되면 스레드로 내려간다. 실패 시 -1 (errno 유지).
+static inline int txn_aio_open(TxnAio *a, int fd, size_t size, int backend) {
+    memset(a, 0, sizeof(*a));
+    a->fd = fd;
+    a->size = size;
+    a->ring.ring_fd = -1;
+    if (posix_memalign((void **)&a->bufs, 4096, (size_t)TXN_AIO_DEPTH * TXN_AIO_CHUNK) != 0) {
+        errno = ENOMEM;
+        return -1;
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    if (backend == TXN_AIO_URING && txn_uring_setup(&a->ring, TXN_AIO_DEPTH * 2) == 0) {
+        a->backend = TXN_AIO_URING;
+        for (size_t c = 0; c < TXN_AIO_DEPTH; c++) {
+            if (txn_uring_submit_read(a, c) < 0) {
+                int e = errno;
+                txn_uring_close(a);
+                free(a->bufs);
+                errno = e;
+                return -1;
+            }
+        }
+        return 0;
+    }
+
+    a->backend = TXN_AIO_THREAD;
+    pthread_mutex_init(&a->lock, NULL);
+    pthread_cond_init(&a->cond, NULL);
+    if (pthread_create(&a->tid, NULL, txn_aio_prefetcher, a) != 0) {
+        pthread_mutex_destroy(&a->lock);
+        pthread_cond_destroy(&a->cond);
+        free(a->bufs);
+        errno = EAGAIN;
+        return -1;
+    }
+    return 0;
+}
+
+// 현재 조각이 도착할 때까지 기다린다. 0: 준비됨, -1: 오류.
+static inline int txn_aio_acquire(TxnAio *a) {
+    int k = (int)(a->cur % TXN_AIO_DEPTH);
+    TxnAioSlot *s = &a->slot[k];
+    unsigned long long t0 = txn_aio_now_ns();
+    int rc = 0;
+    if (a->backend == TXN_AIO_URING) {
+        if (s->state != TXN_SLOT_DONE)
+            rc = txn_uring_wait(a, k);
+    } else {
+        pthread_mutex_lock(&a->lock);
+        while (s->state != TXN_SLOT_DONE)
+            pthread_cond_wait(&a->cond, &a->lock);
+        pthread_mutex_unlock(&a->lock);
+    }
+    a->wait_ns += txn_aio_now_ns() - t0;
+    if (rc < 0)
+        return -1;
+    if (s->res < 0) {
+        errno = (int)-s->res;
+        return -1;
+    }
+    // io_uring 은 짧게 읽을 수 있다: 나머지를 직접 채운다
+    if ((size_t)s->res < s->len) {
+        ssize_t r = txn_aio_pread_full(a->fd, txn_aio_buf(a, a->cur) + s->res,
+                                       s->len - (size_t)s->res, s->off + (size_t)s->res);
+        if (r < 0) {
+            errno = (int)-r;
+            return -1;
+        }
+        s->len = (size_t)s->res + (size_t)r;  // 파일이 줄었으면 있는 만큼만
+    }
+    return 0;
+}
+
+// 다 쓴 조각의 버퍼로 depth 만큼 뒤 조각을 요청한다.
+static inline void txn_aio_release(TxnAio *a) {
+    TxnAioSlot *s = &a->slot[a->cur % TXN_AIO_DEPTH];
+    size_t next = a->cur + TXN_AIO_DEPTH;
+    if (a->backend == TXN_AIO_URING) {
+        s->state = TXN_SLOT_FREE;
+        txn_uring_submit_read(a, next);
+    } else {
+        pthread_mutex_lock(&a->lock);
+        s->state = TXN_SLOT_FREE;
+        pthread_cond_broadcast(&a->cond);
+        pthread_mutex_unlock(&a->lock);
+    }
+    a->cur++;
+    a->cur_pos = 0;
+    a->have = 0;
+}
+
+// read() 처럼 최대 max 바이트를 파일 순서대로 dst 에 복사한다. 0: 파일 끝, -1: 오류.
+static inline ssize_t txn_aio_read(TxnAio *a, char *dst, size_t max) {
+    if (!a->have) {
+        if (a->cur * (size_t)TXN_AIO_CHUNK >= a->size)
+            return 0;
+        if (txn_aio_acquire(a) < 0)
+            return -1;
+        a->have = 1;
+    }
+    TxnAioSlot *s = &a->slot[a->cur % TXN_AIO_DEPTH];
+    size_t n = s->len - a->cur_pos;
+    if (n > max)
+        n = max;
+    memcpy(dst, txn_aio_buf(a, a->cur) + a->cur_pos, n);
+    a->cur_pos += n;
+    if (a->cur_pos == s->len) {
+        int short_file = s->len < TXN_AIO_CHUNK;
+        txn_aio_release(a);
+        if (short_file)
+            a->size = a->cur * (size_t)TXN_AIO_CHUNK;  // 파일 끝에 닿았다
+    }
+    return (ssize_t)n;
+}
+
+static inline void txn_aio_close(TxnAio *a) {
+    if (a->backend == TXN_AIO_URING) {
+        txn_uring_close(a);
+    } else if (a->backend == TXN_AIO_THREAD) {
+        pthread_mutex_lock(&a->lock);
+        a->stop = 1;
+        pthread_cond_broadcast(&a->cond);
+        pthread_mutex_unlock(&a->lock);
+        pthread_join(a->tid, NULL);
+        pthread_mutex_destroy(&a->lock);
+        pthread_cond_destroy(&a->cond);
+    }
+    free(a->bufs);
+    a->backend = TXN_AIO_NONE;
+}
+
+#endif
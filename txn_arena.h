@@ -0,0 +1,142 @@
+// txn_arena.h
+// 고정 크기 정적 배열(MAX_TASKS) 대신 쓰는 작업 저장소
+//
+// TxnArena 는 큰 블록을 mmap 으로 받아 앞에서부터 잘라 주는 범프 할당기다.
+// 블록 크기는 두 배씩 커지므로 블록 수는 log(전체 크기) 수준이고,
+// 개별 해제 없이 실행이 끝날 때 txn_arena_release() 한 번으로 통째로 돌려준다.
+//
+// TxnTaskList 는 워커 하나의 작업 목록이다. 아레나에서 청크를 받아 이어 붙이며
+// 청크 용량도 두 배씩 늘어나므로, 작업 대부분이 소수의 연속 구간에 모인다.
+//
+//   TxnArena arena;
+//   TxnTaskList atm[2];
+//   txn_arena_init(&arena);
+//   txn_tasks_init(&atm[0], &arena, sizeof(ATMTask));
+//   if (txn_tasks_add(&atm[r->user % 2], &task) < 0) { ... }
+//   TXN_TASKS_EACH(&atm[0], ATMTask, t) { atm_worker_line(t->amount, ...); }
+//   txn_arena_release(&arena);
+
+#ifndef TXN_ARENA_H
+#define TXN_ARENA_H
+
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/mman.h>
+
+#define TXN_ARENA_MIN_BLOCK  (64 * 1024)  // 첫 블록 크기 (바이트)
+#define TXN_TASKS_MIN_CHUNK  256          // 첫 청크 용량 (작업 수)
+#define TXN_ARENA_ALIGN      16
+
+// ---------- 아레나 ----------
+
+typedef struct TxnArenaBlock {
+    struct TxnArenaBlock *next;
+    size_t size;  // 헤더 포함 매핑 크기
+} TxnArenaBlock;
+
+typedef struct {
+    TxnArenaBlock *blocks;
+    char *cur;
+    size_t left;
+    size_t next_size;
+    size_t used;      // 잘라 준 바이트 합
+    size_t mapped;    // 매핑한 바이트 합
+} TxnArena;
+
+static inline void txn_arena_init(TxnArena *a) {
+    memset(a, 0, sizeof(*a));
+    a->next_size = TXN_ARENA_MIN_BLOCK;
+}
+
+// bytes 만큼 잘라 준다 (16바이트 정렬). 실패 시 NULL (errno = ENOMEM).
+static inline void *txn_arena_alloc(TxnArena *a, size_t bytes) {
+    bytes = (bytes + TXN_ARENA_ALIGN - 1) & ~(size_t)(TXN_ARENA_ALIGN - 1);
+    if (bytes > a->left) {
+        size_t hdr = (sizeof(TxnArenaBlock) + TXN_ARENA_ALIGN - 1) & ~(size_t)(TXN_ARENA_ALIGN - 1);
+        size_t size = a->next_size;
+        while (size < bytes + hdr)
+            size *= 2;
+        void *p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            errno = ENOMEM;
+            return NULL;
+        }
+        TxnArenaBlock *b = p;
+        b->next = a->blocks;
+        b->size = size;
+        a->blocks = b;
+        a->cur = (char *)p + hdr;
+        a->left = size - hdr;
+        a->next_size = size * 2;
+        a->mapped += size;
+    }
+    void *r = a->cur;
+    a->cur += bytes;
+    a->left -= bytes;
+    a->used += bytes;
+    return r;
+}
+
+// 아레나에서 나간 모든 메모리를 한 번에 돌려준다.
+static inline void txn_arena_release(TxnArena *a) {
+    TxnArenaBlock *b = a->blocks;
+    while (b) {
+        TxnArenaBlock *next = b->next;
+        munmap(b, b->size);
+        b = next;
+    }
+    txn_arena_init(a);
+}
+
+// ---------- 워커별 작업 목록 ----------
+
+typedef struct TxnTaskChunk {
+    struct TxnTaskChunk *next;
+    size_t count, cap;
+    _Alignas(TXN_ARENA_ALIGN) unsigned char data[];
+} TxnTaskChunk;
+
+typedef struct {
+    TxnArena *arena;
+    size_t elem;            // 작업 하나의 크기
+    TxnTaskChunk *head, *tail;
+    size_t count;
+} TxnTaskList;
+
+static inline void txn_tasks_init(TxnTaskList *l, TxnArena *a, size_t elem) {
+    memset(l, 0, sizeof(*l));
+    l->arena = a;
+    l->elem = elem;
+}
+
+// 작업 하나를 복사해 넣는다. 실패 시 -1 (errno = ENOMEM).
+static inline int txn_tasks_add(TxnTaskList *l, const void *task) {
+    TxnTaskChunk *c = l->tail;
+    if (!c || c->count == c->cap) {
+        size_t cap = c ? c->cap * 2 : TXN_TASKS_MIN_CHUNK;
+        TxnTaskChunk *n = txn_arena_alloc(l->arena, sizeof(TxnTaskChunk) + cap * l->elem);
+        if (!n)
+            return -1;
+        n->next = NULL;
+        n->count = 0;
+        n->cap = cap;
+        if (c)
+            c->next = n;
+        else
+            l->head = n;
+        l->tail = c = n;
+    }
+    memcpy(c->data + c->count * l->elem, task, l->elem);
+    c->count++;
+    l->count++;
+    return 0;
+}
+
+// 목록의 작업을 넣은 순서대로 돈다. it 는 T * 로 선언된다.
+#define TXN_TASKS_EACH(list, T, it)                                              \
+    for (TxnTaskChunk *it##_c = (list)->head; it##_c; it##_c = it##_c->next)     \
+        for (T *it = (T *)(void *)it##_c->data, *it##_end = it + it##_c->count;  \
+             it < it##_end; it++)
+
+#endif
@@ -0,0 +1,77 @@
+// txn_atomic.h
+// 잠금 없는 ATM 입출금 (C11 원자 연산)
+//
+// ATM 처리는 잔액과 ATM 현금을 읽고, 조건을 보고, 다시 쓴다. 워커 여럿이 같은 계좌나
+// 같은 ATM 현금을 고치면 그 사이에 다른 워커의 갱신이 끼어 사라진다.
+// 여기서는 잔액과 현금을 _Atomic int 로 두고
+//
+//   입금 : 두 값에 fetch_add
+//   출금 : 계좌에서 CAS 로 "잔액 ≥ 금액이면 뺀다" → 성공하면 현금에서도 같은 방식으로 뺀다.
+//          현금이 모자라면 계좌에서 뺀 만큼 되돌려 넣고 실패한다.
+//
+// 두 값은 서로 다른 곳 (계좌마다의 잔액, 모두가 함께 쓰는 현금) 에 있어 한 워드로 묶을 수
+// 없으므로, 이것은 두 값을 한꺼번에 바꾸는 원자 연산이 아니다. 보장하는 것은 다음뿐이다.
+//
+//   - 각 값의 갱신은 사라지지 않는다 (값마다 원자적).
+//   - 출금은 끝나고 나면 둘 다 빠졌거나 둘 다 그대로다. 잔액도 현금도 음수가 되지 않는다.
+//   - 모든 처리가 끝난 뒤 (잔액 합계 - 현금) 은 처음과 같다.
+//
+// 보장하지 않는 것:
+//
+//   - 출금 도중에는 계좌에서만 빠진 상태가 다른 워커에게 보인다. 현금 부족으로 되돌려지는
+//     출금이라도 그 사이 같은 계좌의 다른 출금이 잔액 부족으로 실패할 수 있고 (거짓 실패),
+//     그 사이에 잔액을 읽은 쪽은 나중에 되돌려질 차감을 본다.
+//   - 입금은 두 번의 fetch_add 라 그 사이에 잔액과 현금이 어긋난 상태가 보인다.
+//   - 따라서 처리 도중에 잔액과 현금을 함께 읽어 맞춰 보면 맞지 않을 수 있다.
+//
+// 두 값이 항상 같이 보여야 하는 곳은 잔액과 현금을 한 잠금 아래에서 고쳐야 한다
+// (multipar.c 의 atm_lock, txn_locks.h).
+//
+//   _Atomic int card_balance, atm_funds;
+//   txn_atm_deposit(&info->card_balance, &atm_funds, amount);
+//   if (txn_atm_withdraw(&info->card_balance, &atm_funds, withdraw) == TXN_ATM_OK) ...
+//
+// 금액 말고 다른 데이터를 넘겨주지 않으므로 순서 제약 없는(relaxed) 연산으로 충분하다.
+// 잠금이 없는 원자 연산이라 MAP_SHARED 세그먼트의 값에 프로세스끼리 써도 된다.
+
+#ifndef TXN_ATOMIC_H
+#define TXN_ATOMIC_H
+
+#include <stdatomic.h>
+
+enum {
+    TXN_ATM_OK = 0,
+    TXN_ATM_NO_BALANCE,   // 계좌 잔액 부족
+    TXN_ATM_NO_CASH,      // ATM 현금 부족
+};
+
+// *v ≥ amount 이면 amount 를 빼고 1, 아니면 그대로 두고 0. amount 는 0 이상.
+static inline int txn_atomic_take(_Atomic int *v, int amount) {
+    int cur = atomic_load_explicit(v, memory_order_relaxed);
+    do {
+        if (cur < amount)
+            return 0;
+    } while (!atomic_compare_exchange_weak_explicit(v, &cur, cur - amount, memory_order_relaxed,
+                                                    memory_order_relaxed));
+    return 1;
+}
+
+// 잔액, 현금 순서로 더한다. 두 더하기 사이에는 둘이 어긋나 보인다.
+static inline void txn_atm_deposit(_Atomic int *balance, _Atomic int *cash, int amount) {
+    atomic_fetch_add_explicit(balance, amount, memory_order_relaxed);
+    atomic_fetch_add_explicit(cash, amount, memory_order_relaxed);
+}
+
+// 계좌에서 먼저, 그다음 ATM 현금에서 amount 를 뺀다. 둘 다 빠지면 TXN_ATM_OK.
+// 현금이 모자라면 계좌 차감을 되돌린다 (되돌리기 전의 차감은 다른 워커에게 보인다).
+static inline int txn_atm_withdraw(_Atomic int *balance, _Atomic int *cash, int amount) {
+    if (!txn_atomic_take(balance, amount))
+        return TXN_ATM_NO_BALANCE;
+    if (!txn_atomic_take(cash, amount)) {
+        atomic_fetch_add_explicit(balance, amount, memory_order_relaxed);
+        return TXN_ATM_NO_CASH;
+    }
+    return TXN_ATM_OK;
+}
+
+#endif
@@ -0,0 +1,187 @@
+// txn_bank.h
+// 계좌 DB 와 대출(사용자) DB 를 공유 세그먼트 하나에 둔다
+//
+// 실행기(multipar)가 세그먼트를 한 번 만들고 두 테이블을 채운 뒤 ATM/송금/대출
+// 프로세스를 띄운다. fork 된 자식은 매핑을 물려받고, exec 된 대출 처리기는 환경변수
+// TXN_BANK_FD 로 전달된 fd 를 txn_bank_attach() 로 붙인다 (txn_queues.h 와 같은 방식).
+// 그래서 대출금을 복사 없이 바로 카드 잔액에 넣을 수 있다.
+//
+// 레이아웃: [TxnBank][계좌 DB 헤더][계좌 0..users][대출 DB 헤더][사용자 0..users][잠금 표]
+// 두 DB 와 잠금 표는 각각 캐시 라인(TXN_BANK_LINE) 경계에서 시작한다. 배열도 라인 경계에서
+// 시작하게 하려면 DB 구조체의 유연 배열 멤버에 _Alignas(TXN_BANK_LINE) 를 붙인다.
+//
+//   TxnBankShape shape = {sizeof(AccountDB), sizeof(AccountInfo), sizeof(UserDB), sizeof(UserInfo)};
+//   TxnBank *bank = txn_bank_create(max_users, &shape);        // 실행기
+//   TxnBank *bank = txn_bank_attach(&shape);                   // exec 된 자식
+//   AccountDB *acc = txn_bank_accounts(bank);
+//   UserDB *users = txn_bank_users(bank);
+//   TxnLocks *locks = txn_bank_locks(bank);   // 사용자별 줄무늬 잠금 (txn_locks.h)
+//
+// 잠금 표는 txn_bank_create() 가 초기화한다. 계좌 DB 와 대출 DB 의 같은 사용자 칸은
+// 같은 줄무늬가 지킨다.
+// 붙을 때 구조체 크기가 실행기와 하나라도 다르면 거부한다 (EPROTO).
+
+#ifndef TXN_BANK_H
+#define TXN_BANK_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include "txn_locks.h"
+
+#define TXN_BANK_ENV   "TXN_BANK_FD"
+#define TXN_BANK_MAGIC 0x4b4e4254U  // "TBNK"
+#define TXN_BANK_LINE  64
+
+// 두 DB 의 헤더(유연 배열 앞부분 포함 sizeof) 와 원소 크기
+typedef struct {
+    uint64_t account_head, account_elem;
+    uint64_t user_head, user_elem;
+} TxnBankShape;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t line;
+    uint64_t bytes;
+    uint64_t users;            // 사용자 수 (각 배열은 users + 1 칸)
+    TxnBankShape shape;
+    uint64_t account_off;      // 계좌 DB 시작 (세그먼트 기준)
+    uint64_t user_off;         // 대출 DB 시작
+    uint64_t locks_off;        // 잠금 표 시작
+    uint32_t stripes;          // 잠금 표의 줄무늬 수
+} TxnBank;
+
+static inline uint64_t txn_bank_align(uint64_t off) {
+    return (off + TXN_BANK_LINE - 1) & ~(uint64_t)(TXN_BANK_LINE - 1);
+}
+
+static inline void *txn_bank_accounts(TxnBank *b) {
+    return (char *)b + b->account_off;
+}
+
+static inline void *txn_bank_users(TxnBank *b) {
+    return (char *)b + b->user_off;
+}
+
+static inline TxnLocks *txn_bank_locks(TxnBank *b) {
+    return (TxnLocks *)((char *)b + b->locks_off);
+}
+
+// 오프셋을 채우고 전체 크기를 돌려준다. 크기가 넘치면 0.
+static inline uint64_t txn_bank_layout(TxnBank *b, size_t users, const TxnBankShape *s) {
+    if (users >= (UINT64_MAX / 4) / (s->account_elem + s->user_elem + 1))
+        return 0;
+    b->users = users;
+    b->shape = *s;
+    b->account_off = txn_bank_align(sizeof(TxnBank));
+    b->user_off = txn_bank_align(b->account_off + s->account_head + s->account_elem * (users + 1));
+    b->locks_off = txn_bank_align(b->user_off + s->user_head + s->user_elem * (users + 1));
+    b->stripes = txn_locks_stripes(users);
+    return txn_bank_align(b->locks_off + txn_locks_bytes(b->stripes));
+}
+
+// ---------- 생성 (실행기) ----------
+
+// 0 으로 채워진 세그먼트를 만들고 잠금 표를 초기화한다. DB 내용은 호출자가 채운다.
+// 실패 시 NULL (errno 유지).
+static inline TxnBank *txn_bank_create(size_t users, const TxnBankShape *shape) {
+    TxnBank hdr = {0};
+    uint64_t bytes = txn_bank_layout(&hdr, users, shape);
+    if (!bytes) {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    // CLOEXEC 없음: exec 된 대출 처리기가 물려받는다
+    int fd = (int)syscall(SYS_memfd_create, "txn_bank", 0);
+    if (fd < 0)
+        return NULL;
+    void *p = MAP_FAILED;
+    if (ftruncate(fd, (off_t)bytes) == 0)
+        p = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        int e = errno;
+        close(fd);
+        errno = e;
+        return NULL;
+    }
+
+    TxnBank *b = p;
+    *b = hdr;
+    b->magic = TXN_BANK_MAGIC;
+    b->line = TXN_BANK_LINE;
+    b->bytes = bytes;
+    if (txn_locks_init(txn_bank_locks(b), b->stripes) < 0) {
+        int e = errno;
+        munmap(p, bytes);
+        close(fd);
+        errno = e;
+        return NULL;
+    }
+
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%d", fd);
+    setenv(TXN_BANK_ENV, buf, 1);
+    return b;
+}
+
+// ---------- 연결 (exec 된 자식) ----------
+
+// 실행기가 넘긴 세그먼트를 붙인다. 세그먼트가 없으면 NULL (errno = ENOENT),
+// 구조체 크기가 다르면 NULL (errno = EPROTO).
+static inline TxnBank *txn_bank_attach(const TxnBankShape *shape) {
+    const char *env = getenv(TXN_BANK_ENV);
+    if (!env) {
+        errno = ENOENT;
+        return NULL;
+    }
+
+    int fd = atoi(env);
+    struct stat st;
+    if (fstat(fd, &st) < 0)
+        return NULL;
+    if ((size_t)st.st_size < sizeof(TxnBank)) {
+        errno = EPROTO;
+        return NULL;
+    }
+    void *p = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED)
+        return NULL;
+
+    TxnBank *b = p;
+    TxnBank want = {0};
+    if (b->magic != TXN_BANK_MAGIC || b->bytes != (uint64_t)st.st_size ||
+        txn_bank_layout(&want, b->users, shape) != b->bytes ||
+        want.account_off != b->account_off || want.user_off != b->user_off ||
+        want.locks_off != b->locks_off || want.stripes != b->stripes ||
+        memcmp(&b->shape, shape, sizeof(*shape)) != 0) {
+        munmap(p, (size_t)st.st_size);
+        errno = EPROTO;
+        return NULL;
+    }
+    return b;
+}
+
+static inline void txn_bank_release(TxnBank *b) {
+    if (b)
+        munmap(b, b->bytes);
+}
+
+static inline void txn_bank_report(const TxnBank *b) {
+    const TxnBankShape *s = &b->shape;
+    printf("🏦 공유 세그먼트: 사용자 %llu명 | 계좌 DB @%llu (원소 %llu B) | "
+           "대출 DB @%llu (원소 %llu B) | 잠금 @%llu (%u개) | 합계 %.2f MB\n",
+           (unsigned long long)b->users, (unsigned long long)b->account_off,
+           (unsigned long long)s->account_elem, (unsigned long long)b->user_off,
+           (unsigned long long)s->user_elem, (unsigned long long)b->locks_off, b->stripes,
+           b->bytes / (1024.0 * 1024.0));
+    fflush(stdout);
+}
+
+#endif
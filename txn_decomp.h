@@ -0,0 +1,362 @@
+// txn_decomp.h
+// 압축된 입력(zstd / LZ4 프레임)을 별도 스레드에서 풀어 리더에 넘긴다.
+//
+// txn_reader 가 입력 앞 4바이트에서 프레임 매직을 보면 이 모듈을 켠다. 압축 해제 스레드가
+// 원본 fd 를 읽어 TXN_DZ_BLOCK 크기 블록 TXN_DZ_DEPTH 개짜리 고리에 풀어 넣고,
+// 리더는 txn_dz_read() 로 read() 처럼 풀린 바이트를 순서대로 가져간다.
+// 블록이 모두 차 있으면 압축 해제 스레드가 멈추므로 메모리는 일정하다.
+// 여러 프레임을 이어 붙인 파일(zstd -c a b > ab.zst 등)도 끝까지 푼다.
+//
+// 라이브러리는 빌드할 때 고른다.
+//   gcc -O2 -DHAVE_ZSTD -DHAVE_LZ4 a_1.c -o a_1 -lm -lzstd -llz4
+// 해당 지원 없이 빌드했는데 압축 입력이 들어오면 열기가 ENOTSUP 으로 실패한다.
+
+#ifndef TXN_DECOMP_H
+#define TXN_DECOMP_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <signal.h>
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+#ifdef HAVE_LZ4
+#include <lz4frame.h>
+#endif
+
+#ifndef TXN_DZ_BLOCK
+#define TXN_DZ_BLOCK (1 << 20)   // 풀린 데이터 블록 크기 (바이트)
+#endif
+#define TXN_DZ_DEPTH 4           // 블록 수
+#define TXN_DZ_IN    (256 << 10) // 압축 입력 읽기 단위
+
+#define TXN_DZ_NONE 0
+#define TXN_DZ_ZSTD 1
+#define TXN_DZ_LZ4  2
+
+typedef struct {
+    char *data;
+    size_t len;
+    int full;
+} TxnDzBlock;
+
+typedef struct {
+    int kind;
+    int src_fd;
+    char *prefix;                    // 종류를 알아내느라 먼저 읽어 버린 바이트
+    size_t prefix_len, prefix_pos;
+    TxnDzBlock blk[TXN_DZ_DEPTH];
+    size_t cur, cur_pos;             // 소비자 위치 (블록 번호, 블록 안 바이트)
+    int done;                        // 압축 해제 스레드가 끝났다
+    int err;                         // 0 이 아니면 errno 값
+    int stop;
+    unsigned long long in_bytes, out_bytes;
+    pthread_t tid;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} TxnDecomp;
+
+// 앞 n 바이트로 압축 종류를 알아낸다.
+static inline int txn_decomp_kind(const void *p, size_t n) {
+    if (n < 4)
+        return TXN_DZ_NONE;
+    const unsigned char *b = p;
+    uint32_t magic = (uint32_t)b[0] | (uint32_t)b[1] << 8 | (uint32_t)b[2] << 16 | (uint32_t)b[3] << 24;
+    if (magic == 0xFD2FB528U)
+        return TXN_DZ_ZSTD;
+    if (magic == 0x184D2204U)
+        return TXN_DZ_LZ4;
+    return TXN_DZ_NONE;
+}
+
+static inline const char *txn_decomp_name(int kind) {
+    return kind == TXN_DZ_ZSTD ? "zstd" : kind == TXN_DZ_LZ4 ? "lz4" : "없음";
+}
+
+static inline int txn_decomp_supported(int kind) {
+#ifdef HAVE_ZSTD
+    if (kind == TXN_DZ_ZSTD)
+        return 1;
+#endif
+#ifdef HAVE_LZ4
+    if (kind == TXN_DZ_LZ4)
+        return 1;
+#endif
+    (void)kind;
+    return 0;
+}
+
+// ---------- 압축 해제 스레드 ----------
+
+// 다음에 채울 블록이 빌 때까지 기다린다. stop 이면 NULL.
+static inline TxnDzBlock *txn_dz_acquire(TxnDecomp *z, size_t no) {
+    TxnDzBlock *b = &z->blk[no % TXN_DZ_DEPTH];
+    pthread_mutex_lock(&z->lock);
+    while (b->full && !z->stop)
+        pthread_cond_wait(&z->cond, &z->lock);
+    int stop = z->stop;
+    pthread_mutex_unlock(&z->lock);
+    if (stop)
+        return NULL;
+    b->len = 0;
+    return b;
+}
+
+static inline void txn_dz_publish(TxnDecomp *z, TxnDzBlock *b) {
+    pthread_mutex_lock(&z->lock);
+    b->full = 1;
+    z->out_bytes += b->len;
+    pthread_cond_broadcast(&z->cond);
+    pthread_mutex_unlock(&z->lock);
+}
+
+// 압축 입력을 조금 읽는다. 먼저 읽어 둔 prefix 부터 넘긴다.
+// 스레드는 여기 read() 에서만 취소될 수 있다 (txn_decomp_close 참고).
+static inline ssize_t txn_dz_fill(TxnDecomp *z, char *in) {
+    if (z->prefix_pos < z->prefix_len) {
+        size_t n = z->prefix_len - z->prefix_pos;
+        if (n > TXN_DZ_IN)
+            n = TXN_DZ_IN;
+        memcpy(in, z->prefix + z->prefix_pos, n);
+        z->prefix_pos += n;
+        z->in_bytes += n;
+        return (ssize_t)n;
+    }
+    for (;;) {
+        pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
+        ssize_t r = read(z->src_fd, in, TXN_DZ_IN);
+        pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+        if (r < 0 && errno == EINTR)
+            continue;
+        if (r > 0)
+            z->in_bytes += (size_t)r;
+        return r;
+    }
+}
+
+// 압축 해제 스레드의 입력 버퍼와 코덱 상태. read() 에서 취소돼도 정리 함수가 푼다.
+typedef struct {
+    char *in;
+#ifdef HAVE_ZSTD
+    ZSTD_DStream *zs;
+#endif
+#ifdef HAVE_LZ4
+    LZ4F_dctx *lz;
+#endif
+} TxnDzState;
+
+static inline void txn_dz_cleanup(void *arg) {
+    TxnDzState *st = arg;
+#ifdef HAVE_ZSTD
+    ZSTD_freeDStream(st->zs);
+#endif
+#ifdef HAVE_LZ4
+    if (st->lz)
+        LZ4F_freeDecompressionContext(st->lz);
+#endif
+    free(st->in);
+}
+
+static inline void *txn_dz_worker(void *arg) {
+    TxnDecomp *z = arg;
+    pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+    TxnDzState st;
+    memset(&st, 0, sizeof(st));
+    st.in = malloc(TXN_DZ_IN);
+    char *in = st.in;
+    int err = in ? 0 : ENOMEM;
+
+#ifdef HAVE_ZSTD
+    if (!err && z->kind == TXN_DZ_ZSTD && !(st.zs = ZSTD_createDStream()))
+        err = ENOMEM;
+    ZSTD_DStream *zs = st.zs;
+#endif
+#ifdef HAVE_LZ4
+    if (!err && z->kind == TXN_DZ_LZ4 &&
+        LZ4F_isError(LZ4F_createDecompressionContext(&st.lz, LZ4F_VERSION)))
+        err = ENOMEM;
+    LZ4F_dctx *lz = st.lz;
+#endif
+    pthread_cleanup_push(txn_dz_cleanup, &st);
+
+    size_t in_len = 0, in_pos = 0, no = 0;
+    int more_out = 0;       // 출력 블록을 가득 채웠다: 입력 없이 한 번 더 불러야 할 수 있다
+    int frame_open = 0;     // 프레임 중간에서 입력이 끝나면 잘린 파일
+    TxnDzBlock *b = err ? NULL : txn_dz_acquire(z, no);
+
+    while (b && !err) {
+        if (in_pos == in_len && !more_out) {
+            ssize_t r = txn_dz_fill(z, in);
+            if (r < 0)
+                err = errno;
+            if (r <= 0)
+                break;
+            in_len = (size_t)r;
+            in_pos = 0;
+        }
+
+#ifdef HAVE_ZSTD
+        if (z->kind == TXN_DZ_ZSTD) {
+            ZSTD_inBuffer ib = {in, in_len, in_pos};
+            ZSTD_outBuffer ob = {b->data, TXN_DZ_BLOCK, b->len};
+            size_t ret = ZSTD_decompressStream(zs, &ob, &ib);
+            if (ZSTD_isError(ret)) {
+                fprintf(stderr, "zstd 압축 해제 실패: %s\n", ZSTD_getErrorName(ret));
+                err = EILSEQ;
+                break;
+            }
+            in_pos = ib.pos;
+            b->len = ob.pos;
+            frame_open = ret != 0;
+        }
+#endif
+#ifdef HAVE_LZ4
+        if (z->kind == TXN_DZ_LZ4) {
+            size_t dst = TXN_DZ_BLOCK - b->len, src = in_len - in_pos;
+            size_t ret = LZ4F_decompress(lz, b->data + b->len, &dst, in + in_pos, &src, NULL);
+            if (LZ4F_isError(ret)) {
+                fprintf(stderr, "lz4 압축 해제 실패: %s\n", LZ4F_getErrorName(ret));
+                err = EILSEQ;
+                break;
+            }
+            in_pos += src;
+            b->len += dst;
+            frame_open = ret != 0;
+        }
+#endif
+        more_out = b->len == TXN_DZ_BLOCK;
+        if (more_out) {
+            txn_dz_publish(z, b);
+            b = txn_dz_acquire(z, ++no);
+        }
+    }
+
+    if (!err && frame_open && !z->stop) {
+        fprintf(stderr, "%s 압축 입력이 프레임 중간에서 끝났다\n", txn_decomp_name(z->kind));
+        err = EIO;
+    }
+    if (b && b->len)
+        txn_dz_publish(z, b);
+
+    pthread_cleanup_pop(1);
+
+    pthread_mutex_lock(&z->lock);
+    z->err = err;
+    z->done = 1;
+    pthread_cond_broadcast(&z->cond);
+    pthread_mutex_unlock(&z->lock);
+    return NULL;
+}
+
+// ---------- 소비자 ----------
+
+// src_fd 의 압축 스트림 풀기를 시작한다. prefix 는 이미 읽어 버린 앞부분 (복사해 둔다).
+// 실패 시 -1 (errno 유지, 지원 없이 빌드했으면 ENOTSUP).
+static inline int txn_decomp_open(TxnDecomp *z, int kind, int src_fd, const void *prefix,
+                                  size_t prefix_len) {
+    memset(z, 0, sizeof(*z));
+    if (!txn_decomp_supported(kind)) {
+        fprintf(stderr, "%s 압축 입력: -DHAVE_%s 로 다시 빌드해야 한다\n",
+                txn_decomp_name(kind), kind == TXN_DZ_ZSTD ? "ZSTD (-lzstd)" : "LZ4 (-llz4)");
+        errno = ENOTSUP;
+        return -1;
+    }
+    z->kind = kind;
+    z->src_fd = src_fd;
+    if (prefix_len) {
+        z->prefix = malloc(prefix_len);
+        if (!z->prefix) {
+            errno = ENOMEM;
+            return -1;
+        }
+        memcpy(z->prefix, prefix, prefix_len);
+        z->prefix_len = prefix_len;
+    }
+    for (int i = 0; i < TXN_DZ_DEPTH; i++) {
+        z->blk[i].data = malloc(TXN_DZ_BLOCK);
+        if (!z->blk[i].data) {
+            for (int j = 0; j < i; j++)
+                free(z->blk[j].data);
+            free(z->prefix);
+            errno = ENOMEM;
+            return -1;
+        }
+    }
+    pthread_mutex_init(&z->lock, NULL);
+    pthread_cond_init(&z->cond, NULL);
+
+    // 압축 해제 스레드는 SIGPIPE 를 받지 않는다 (원본이 파이프일 때 상류가 끊겨도 오류로만 본다)
+    sigset_t set, old;
+    sigemptyset(&set);
+    sigaddset(&set, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &set, &old);
+    int rc = pthread_create(&z->tid, NULL, txn_dz_worker, z);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    if (rc != 0) {
+        for (int i = 0; i < TXN_DZ_DEPTH; i++)
+            free(z->blk[i].data);
+        free(z->prefix);
+        pthread_mutex_destroy(&z->lock);
+        pthread_cond_destroy(&z->cond);
+        errno = rc;
+        return -1;
+    }
+    return 0;
+}
+
+// read() 처럼 풀린 바이트를 최대 max 개 복사한다. 0: 끝, -1: 오류 (errno).
+static inline ssize_t txn_dz_read(TxnDecomp *z, char *dst, size_t max) {
+    TxnDzBlock *b = &z->blk[z->cur % TXN_DZ_DEPTH];
+    pthread_mutex_lock(&z->lock);
+    while (!b->full && !z->done)
+        pthread_cond_wait(&z->cond, &z->lock);
+    int full = b->full, err = z->err;
+    pthread_mutex_unlock(&z->lock);
+    if (!full) {
+        if (err) {
+            errno = err;
+            return -1;
+        }
+        return 0;
+    }
+
+    size_t n = b->len - z->cur_pos;
+    if (n > max)
+        n = max;
+    memcpy(dst, b->data + z->cur_pos, n);
+    z->cur_pos += n;
+    if (z->cur_pos == b->len) {
+        pthread_mutex_lock(&z->lock);
+        b->full = 0;
+        pthread_cond_broadcast(&z->cond);
+        pthread_mutex_unlock(&z->lock);
+        z->cur++;
+        z->cur_pos = 0;
+    }
+    return (ssize_t)n;
+}
+
+// 끝까지 읽기 전에 닫으면 압축 해제 스레드를 멈춘다.
+// 원본(stdin 등) read 에서 막혀 있을 수 있으므로 그 경우만 취소한다.
+static inline void txn_decomp_close(TxnDecomp *z) {
+    pthread_mutex_lock(&z->lock);
+    int done = z->done;
+    z->stop = 1;
+    pthread_cond_broadcast(&z->cond);
+    pthread_mutex_unlock(&z->lock);
+    if (!done)
+        pthread_cancel(z->tid);
+    pthread_join(z->tid, NULL);
+    for (int i = 0; i < TXN_DZ_DEPTH; i++)
+        free(z->blk[i].data);
+    free(z->prefix);
+    pthread_mutex_destroy(&z->lock);
+    pthread_cond_destroy(&z->cond);
+}
+
+#endif
@@ -0,0 +1,203 @@
+// txn_dispatch.h
+// 작업을 워커별 연속 배열로 한 번에 나눈다
+//
+// 예전에는 워커 수가 드라이버마다 컴파일 상수였고 (NUM_WORKERS, THREAD_COUNT), 워커마다
+// 전체 작업 목록을 훑으며 자기 몫(user % 워커 수)만 골라 처리했다 (워커 수 × 건수).
+// 여기서는 계수 정렬로 한 번만 나눈다. 나누는 일도 여러 스레드가 함께 한다.
+//
+//   1. 입력을 스레드 수만큼 연속 구간으로 자르고 각 스레드가 자기 구간의 워커별 건수를 센다.
+//   2. 모두 센 뒤 (barrier) 각 스레드가 "앞 워커들의 전체 건수 + 같은 워커에서 앞 스레드들의
+//      건수" 로 자기 쓰기 위치를 구한다.
+//   3. 각 스레드가 자기 구간을 그 위치로 흩뿌린다. 쓰는 칸이 겹치지 않아 잠금이 필요 없다.
+//
+// 워커 w 의 몫은 recs[start[w] .. start[w + 1]) 에 입력 순서대로 (spans 를 이어 붙인 순서)
+// 놓이므로 사용자별 처리 순서는 예전과 같다. 워커는 txn_record_owner 로 고르며
+// txn_part_owner (txn_partition.h) 와 같은 규칙이라 계좌 배치와 어긋나지 않는다.
+// 워커별 배열은 아레나 (txn_arena.h) 한 블록에 잡으므로 txn_buckets_free 는 O(1) 이다.
+//
+//   num_workers = txn_workers_arg(&argc, argv, DEFAULT_WORKERS);  // 잘못된 값이면 0
+//   const TxnRecord *spans[3] = {atm, loan, transfer};
+//   size_t counts[3] = {n_atm, n_loan, n_transfer};
+//   TxnBuckets b;
+//   txn_buckets_build(&b, spans, counts, 3, num_workers);
+//   size_t n;
+//   const TxnRecord *mine = txn_bucket(&b, w, &n);
+//   txn_buckets_report(&b, "작업");
+//   txn_buckets_free(&b);
+//
+// 워커 수는 실행 시점에 정한다 (txn_workers.h).
+
+#ifndef TXN_DISPATCH_H
+#define TXN_DISPATCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include "txn_reader.h"
+#include "txn_workers.h"
+#include "txn_arena.h"
+
+#define TXN_BUCKET_LINE   64
+#define TXN_BUCKET_GRAIN  16384   // 나누기 스레드 하나가 맡을 최소 건수
+
+// ---------- 워커별 나누기 ----------
+
+typedef struct {
+    TxnArena arena;                        // recs 를 담는다. 풀 때 통째로 돌려준다
+    TxnRecord *recs;                       // 워커 순, 워커 안에서는 입력 순서
+    size_t start[TXN_WORKERS_MAX + 1];     // 워커 w 의 몫은 recs[start[w] .. start[w + 1])
+    size_t total;
+    unsigned parts;
+    unsigned threads;                      // 나누는 데 쓴 스레드 수
+    double sec;
+} TxnBuckets;
+
+typedef struct TxnBucketJob TxnBucketJob;
+
+// 스레드마다 캐시 라인 경계에서 시작한다 (건수 세기가 서로의 라인을 건드리지 않게)
+typedef struct {
+    _Alignas(TXN_BUCKET_LINE) size_t hist[TXN_WORKERS_MAX];   // 센 건수 → 흩뿌릴 위치
+    TxnBucketJob *job;
+    size_t begin, end;                     // spans 를 이어 붙인 순번 구간
+} TxnBucketPart;
+
+struct TxnBucketJob {
+    TxnBuckets *b;
+    const TxnRecord *const *spans;
+    const size_t *counts;
+    int nspans;
+    pthread_barrier_t counted;
+    TxnBucketPart *part;
+};
+
+// 스레드 구간 [begin, end) 를 spans 별 조각으로 훑으며 센다 (scatter 면 흩뿌린다)
+static inline void txn_bucket_scan(TxnBucketPart *p, int scatter) {
+    TxnBucketJob *j = p->job;
+    unsigned parts = j->b->parts;
+    size_t base = 0;
+    for (int s = 0; s < j->nspans && base < p->end; base += j->counts[s], s++) {
+        size_t lo = p->begin > base ? p->begin - base : 0;
+        size_t hi = p->end - base < j->counts[s] ? p->end - base : j->counts[s];
+        const TxnRecord *src = j->spans[s];
+        if (scatter) {
+            for (size_t i = lo; i < hi; i++)
+                j->b->recs[p->hist[txn_record_owner(&src[i], parts)]++] = src[i];
+        } else {
+            for (size_t i = lo; i < hi; i++)
+                p->hist[txn_record_owner(&src[i], parts)]++;
+        }
+    }
+}
+
+static inline void *txn_bucket_thread(void *arg) {
+    TxnBucketPart *p = arg;
+    TxnBucketJob *j = p->job;
+    TxnBuckets *b = j->b;
+    unsigned self = (unsigned)(p - j->part);
+    txn_bucket_scan(p, 0);
+    pthread_barrier_wait(&j->counted);
+
+    // 워커 w 의 쓰기 위치 = 앞 워커들의 전체 건수 + 같은 워커에서 앞 스레드들의 건수.
+    // 다른 스레드가 아직 hist 를 읽고 있으므로 위치는 따로 구해 두고, 모두 다 구한 뒤에 덮어쓴다.
+    size_t pos[TXN_WORKERS_MAX], acc = 0;
+    for (unsigned w = 0; w < b->parts; w++) {
+        size_t mine = acc;
+        for (unsigned t = 0; t < b->threads; t++) {
+            if (t < self)
+                mine += j->part[t].hist[w];
+            acc += j->part[t].hist[w];
+        }
+        if (self == 0)
+            b->start[w] = mine;
+        pos[w] = mine;
+    }
+    pthread_barrier_wait(&j->counted);
+    memcpy(p->hist, pos, b->parts * sizeof(size_t));
+    txn_bucket_scan(p, 1);
+    return NULL;
+}
+
+// spans[0..nspans) 를 이어 붙인 레코드를 parts 개 워커 몫으로 복사해 나눈다.
+// 원본은 곧바로 풀어도 된다. 실패 시 -1 (errno 설정).
+static inline int txn_buckets_build(TxnBuckets *b, const TxnRecord *const spans[],
+                                    const size_t counts[], int nspans, unsigned parts) {
+    memset(b, 0, sizeof(*b));
+    if (parts < 1 || parts > TXN_WORKERS_MAX) {
+        errno = EINVAL;
+        return -1;
+    }
+    for (int s = 0; s < nspans; s++)
+        b->total += counts[s];
+    b->parts = parts;
+    b->threads = (unsigned)(b->total / TXN_BUCKET_GRAIN);
+    if (b->threads > parts)
+        b->threads = parts;
+    if (b->threads < 1)
+        b->threads = 1;
+
+    TxnBucketJob job = {.b = b, .spans = spans, .counts = counts, .nspans = nspans};
+    txn_arena_init(&b->arena);
+    b->recs = txn_arena_alloc(&b->arena, (b->total ? b->total : 1) * sizeof(TxnRecord));
+    job.part = aligned_alloc(TXN_BUCKET_LINE, b->threads * sizeof(TxnBucketPart));
+    if (!b->recs || !job.part) {
+        txn_arena_release(&b->arena);
+        free(job.part);
+        b->recs = NULL;
+        errno = ENOMEM;
+        return -1;
+    }
+    pthread_barrier_init(&job.counted, NULL, b->threads);
+
+    unsigned long long t0 = txn_now_ns();
+    pthread_t tids[TXN_WORKERS_MAX];
+    for (unsigned t = 0; t < b->threads; t++) {
+        TxnBucketPart *p = &job.part[t];
+        memset(p->hist, 0, sizeof(p->hist));
+        p->job = &job;
+        p->begin = b->total * t / b->threads;
+        p->end = b->total * (t + 1) / b->threads;
+    }
+    for (unsigned t = 1; t < b->threads; t++) {
+        int rc = pthread_create(&tids[t], NULL, txn_bucket_thread, &job.part[t]);
+        if (rc != 0) {
+            // barrier 는 모든 스레드를 기다리므로 일부만 띄운 채로는 끝낼 수 없다
+            errno = rc;
+            perror("나누기 스레드 생성 실패");
+            exit(1);
+        }
+    }
+    txn_bucket_thread(&job.part[0]);
+    for (unsigned t = 1; t < b->threads; t++)
+        pthread_join(tids[t], NULL);
+    b->start[parts] = b->total;
+    b->sec = (txn_now_ns() - t0) / 1e9;
+
+    pthread_barrier_destroy(&job.counted);
+    free(job.part);
+    return 0;
+}
+
+static inline const TxnRecord *txn_bucket(const TxnBuckets *b, unsigned w, size_t *n) {
+    *n = b->start[w + 1] - b->start[w];
+    return &b->recs[b->start[w]];
+}
+
+// fork 전에 불리는 일이 많으므로 바로 내보낸다
+static inline void txn_buckets_report(const TxnBuckets *b, const char *label) {
+    printf("🪣 %s 나누기: 워커 %u개 | %zu건 | 스레드 %u개 | %.6f 초 |", label, b->parts,
+           b->total, b->threads, b->sec);
+    for (unsigned w = 0; w < b->parts; w++)
+        printf(" #%u %zu건", w, b->start[w + 1] - b->start[w]);
+    printf("\n");
+    fflush(stdout);
+}
+
+// 워커별 배열 전체를 아레나째 한 번에 돌려준다
+static inline void txn_buckets_free(TxnBuckets *b) {
+    txn_arena_release(&b->arena);
+    b->recs = NULL;
+}
+
+#endif
@@ -0,0 +1,149 @@
+// txn_huge.h
+// 수백만 명 테이블용 큰 페이지(2MB) 할당
+//
+// 사용자 번호로 무작위 접근하는 100MB 테이블을 4KB 페이지로 잡으면 TLB 항목 2만여 개가
+// 필요해 거의 매번 dTLB 미스가 난다. 2MB 페이지면 50개 남짓으로 줄어든다.
+//
+// 순서대로 시도한다:
+//   1. MAP_HUGETLB  : 미리 예약된 hugetlbfs 페이지 (vm.nr_hugepages > 0 일 때)
+//   2. THP          : 2MB 정렬 익명 매핑 + madvise(MADV_HUGEPAGE)
+//   3. 일반 4KB 페이지
+// 환경변수 TXN_HUGEPAGE=off|thp|tlb 로 어디서부터 시도할지 정한다 (기본 auto = tlb).
+//
+//   TxnHuge h;
+//   int *t = txn_huge_alloc(&h, bytes);   // 페이지는 아직 붙지 않았다 (first-touch 유지)
+//   ...
+//   txn_huge_report(&h, "계좌");
+//   txn_huge_free(&h);
+
+#ifndef TXN_HUGE_H
+#define TXN_HUGE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <sys/mman.h>
+
+#define TXN_HUGE_PAGE (2UL * 1024 * 1024)
+#define TXN_HUGE_ENV  "TXN_HUGEPAGE"
+
+enum { TXN_HUGE_NONE = 0, TXN_HUGE_THP = 1, TXN_HUGE_TLB = 2 };
+
+typedef struct {
+    void *base;
+    size_t bytes;    // 매핑 크기 (2MB 배수로 올림)
+    int kind;
+} TxnHuge;
+
+static inline const char *txn_huge_name(int kind) {
+    switch (kind) {
+    case TXN_HUGE_TLB: return "hugetlb";
+    case TXN_HUGE_THP: return "THP";
+    default:           return "4KB";
+    }
+}
+
+// TXN_HUGEPAGE 가 허용하는 가장 큰 종류. 알 수 없는 값이면 auto.
+static inline int txn_huge_wanted(void) {
+    const char *e = getenv(TXN_HUGE_ENV);
+    if (!e || strcmp(e, "auto") == 0)
+        return -1;
+    if (strcmp(e, "off") == 0)
+        return TXN_HUGE_NONE;
+    if (strcmp(e, "thp") == 0)
+        return TXN_HUGE_THP;
+    if (strcmp(e, "tlb") == 0)
+        return TXN_HUGE_TLB;
+    return -1;
+}
+
+// 2MB 정렬된 익명 매핑. 넉넉히 잡은 뒤 앞뒤를 잘라 낸다.
+static inline void *txn_huge_map_aligned(size_t bytes) {
+    size_t span = bytes + TXN_HUGE_PAGE;
+    char *p = mmap(NULL, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED)
+        return NULL;
+    char *a = (char *)(((uintptr_t)p + TXN_HUGE_PAGE - 1) & ~(uintptr_t)(TXN_HUGE_PAGE - 1));
+    if (a > p)
+        munmap(p, (size_t)(a - p));
+    if (a + bytes < p + span)
+        munmap(a + bytes, (size_t)(p + span - (a + bytes)));
+    return a;
+}
+
+// bytes 이상을 잡는다. 실패 시 NULL (errno = ENOMEM).
+static inline void *txn_huge_alloc(TxnHuge *h, size_t bytes) {
+    int want = txn_huge_wanted();
+    size_t size = (bytes + TXN_HUGE_PAGE - 1) & ~(TXN_HUGE_PAGE - 1);
+    void *p = MAP_FAILED;
+    memset(h, 0, sizeof(*h));
+
+#ifdef MAP_HUGETLB
+    if (want < 0 || want == TXN_HUGE_TLB) {
+        p = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED)
+            h->kind = TXN_HUGE_TLB;
+    }
+#endif
+    if (p == MAP_FAILED && want != TXN_HUGE_NONE) {
+        void *a = txn_huge_map_aligned(size);
+        if (a) {
+            p = a;
+#ifdef MADV_HUGEPAGE
+            if (madvise(a, size, MADV_HUGEPAGE) == 0)
+                h->kind = TXN_HUGE_THP;
+#endif
+        }
+    }
+    if (p == MAP_FAILED) {
+        p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            errno = ENOMEM;
+            return NULL;
+        }
+    }
+    h->base = p;
+    h->bytes = size;
+    return p;
+}
+
+static inline void txn_huge_free(TxnHuge *h) {
+    if (h->base)
+        munmap(h->base, h->bytes);
+    h->base = NULL;
+}
+
+// 매핑 중 실제로 2MB 페이지가 붙은 바이트 수 (/proc/self/smaps 의 AnonHugePages).
+// hugetlb 는 전부, 알 수 없으면 0.
+static inline size_t txn_huge_backed(const TxnHuge *h) {
+    if (h->kind == TXN_HUGE_TLB)
+        return h->bytes;
+    FILE *fp = fopen("/proc/self/smaps", "r");
+    if (!fp)
+        return 0;
+    char line[256];
+    int in = 0;
+    size_t kb = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        unsigned long lo, hi;
+        if (sscanf(line, "%lx-%lx ", &lo, &hi) == 2) {
+            in = lo < (uintptr_t)h->base + h->bytes && hi > (uintptr_t)h->base;
+            continue;
+        }
+        size_t v;
+        if (in && sscanf(line, "AnonHugePages: %zu kB", &v) == 1)
+            kb += v;
+    }
+    fclose(fp);
+    return kb * 1024;
+}
+
+static inline void txn_huge_report(const TxnHuge *h, const char *label) {
+    printf("🐘 %s 페이지: %s | %.1f MB 중 2MB 페이지 %.1f MB\n", label, txn_huge_name(h->kind),
+           h->bytes / (1024.0 * 1024.0), txn_huge_backed(h) / (1024.0 * 1024.0));
+}
+
+#endif
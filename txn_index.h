@@ -0,0 +1,258 @@
+// txn_index.h
+// type 별 레코드 위치 색인 (입력 파일 옆 사이드카 파일로 캐시)
+//
+// 한 번 입력 전체를 훑어 type 별로 레코드 위치를 모아 <입력>.tidx 에 저장한다.
+// 텍스트 입력은 줄 시작 바이트 오프셋, 바이너리 입력은 레코드 번호를 담는다.
+// 다음 실행부터는 입력 크기와 mtime 이 같으면 사이드카를 그대로 매핑하므로 훑기를
+// 건너뛰고, 대출만 필요한 소비자는 대출 줄로 바로 가서 그 줄만 해석한다.
+//
+//   TxnIndex ix;
+//   if (txn_index_open(&ix, path) < 0) { ... }   // 일반 파일이 아니면 실패
+//   for (size_t i = 0; i < ix.count[TXN_LOAN]; i++)
+//       if (!txn_index_read(&rd, &ix, TXN_LOAN, i, &rec)) { ... }  // 색인이 입력과 어긋남
+//   txn_index_close(&ix);
+//
+// 사이드카를 쓸 수 없는 위치(읽기 전용 디렉터리 등)면 메모리에만 만들고 계속한다.
+
+#ifndef TXN_INDEX_H
+#define TXN_INDEX_H
+
+#include <stdlib.h>
+#include "txn_reader.h"
+
+#define TXN_IDX_MAGIC   "TXNIDX\0\0"
+#define TXN_IDX_VERSION 1
+#define TXN_IDX_SUFFIX  ".tidx"
+
+// ---------- 사이드카 형식 ----------
+// [TxnIdxHeader 96바이트][ATM 위치][대출 위치][송금 위치], 위치는 uint64 (호스트 바이트 순서)
+
+typedef struct {
+    char     magic[8];
+    uint32_t version;
+    uint32_t binary;        // 1: 위치가 레코드 번호
+    uint64_t input_size;
+    int64_t  mtime_sec;
+    int64_t  mtime_nsec;
+    uint64_t count[4];
+    uint64_t reserved[3];
+} TxnIdxHeader;
+
+_Static_assert(sizeof(TxnIdxHeader) == 96, "TxnIdxHeader 는 96바이트여야 한다");
+
+typedef struct {
+    TxnIdxHeader *hdr;      // 매핑된 사이드카 또는 malloc 한 버퍼
+    size_t bytes;
+    int mapped;
+    int cached;             // 1: 사이드카를 재사용했다
+    size_t count[4];
+    const uint64_t *pos[4];
+    double build_sec;
+} TxnIndex;
+
+static inline int txn_index_matches(const TxnIdxHeader *h, size_t bytes, const struct stat *st) {
+    if (bytes < sizeof(TxnIdxHeader) || memcmp(h->magic, TXN_IDX_MAGIC, 8) != 0 ||
+        h->version != TXN_IDX_VERSION || h->input_size != (uint64_t)st->st_size ||
+        h->mtime_sec != (int64_t)st->st_mtim.tv_sec || h->mtime_nsec != (int64_t)st->st_mtim.tv_nsec)
+        return 0;
+    uint64_t total = 0;
+    for (int t = TXN_ATM; t <= TXN_TRANSFER; t++)
+        total += h->count[t];
+    return bytes == sizeof(TxnIdxHeader) + total * sizeof(uint64_t);
+}
+
+static inline void txn_index_setup(TxnIndex *ix) {
+    const uint64_t *p = (const uint64_t *)(ix->hdr + 1);
+    for (int t = TXN_ATM; t <= TXN_TRANSFER; t++) {
+        ix->count[t] = (size_t)ix->hdr->count[t];
+        ix->pos[t] = p;
+        p += ix->count[t];
+    }
+}
+
+// 사이드카가 유효하면 매핑한다. 1: 성공, 0: 없음/오래됨.
+static inline int txn_index_load(TxnIndex *ix, const char *side, const struct stat *st) {
+    int fd = open(side, O_RDONLY);
+    if (fd < 0)
+        return 0;
+    struct stat sst;
+    void *p = MAP_FAILED;
+    if (fstat(fd, &sst) == 0 && (size_t)sst.st_size >= sizeof(TxnIdxHeader))
+        p = mmap(NULL, (size_t)sst.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+        return 0;
+    if (!txn_index_matches(p, (size_t)sst.st_size, st)) {
+        munmap(p, (size_t)sst.st_size);
+        return 0;
+    }
+    ix->hdr = p;
+    ix->bytes = (size_t)sst.st_size;
+    ix->mapped = 1;
+    ix->cached = 1;
+    txn_index_setup(ix);
+    return 1;
+}
+
+// 입력을 훑어 색인을 만든다. 실패 시 -1 (errno 유지).
+static inline int txn_index_build(TxnIndex *ix, const char *path, const struct stat *st) {
+    TxnReader rd;
+    if (txn_reader_open_mmap(&rd, path) < 0)
+        return -1;
+    if (rd.stream) {
+        // 압축 파일은 오프셋으로 건너뛸 수 없다
+        txn_reader_close(&rd);
+        errno = ESPIPE;
+        return -1;
+    }
+
+    uint64_t *pos[4] = {0};
+    size_t cnt[4] = {0}, cap[4] = {0};
+    int failed = 0;
+    size_t at = 0;
+
+    for (;;) {
+        TxnRecord rec;
+        int ok = 0;
+        if (rd.binary) {
+            if (rd.pos >= rd.bin_count)
+                break;
+            at = rd.pos;
+            rec = rd.bin_recs[rd.pos++];
+            txn_record_le(&rec);
+            ok = rec.type >= TXN_ATM && rec.type <= TXN_TRANSFER;
+        } else {
+            if (rd.pos >= rd.size)
+                break;
+            at = rd.pos;
+            const char *next = txn_parse_line(rd.data + rd.pos, rd.data + rd.size, &rec, &ok);
+            rd.pos = (size_t)(next - rd.data);
+        }
+        if (!ok)
+            continue;
+
+        int t = rec.type;
+        if (cnt[t] == cap[t]) {
+            size_t nc = cap[t] ? cap[t] * 2 : 1024;
+            uint64_t *np = realloc(pos[t], nc * sizeof(uint64_t));
+            if (!np) {
+                failed = 1;
+                break;
+            }
+            pos[t] = np;
+            cap[t] = nc;
+        }
+        pos[t][cnt[t]++] = at;
+    }
+
+    size_t total = cnt[TXN_ATM] + cnt[TXN_LOAN] + cnt[TXN_TRANSFER];
+    size_t bytes = sizeof(TxnIdxHeader) + total * sizeof(uint64_t);
+    TxnIdxHeader *h = failed ? NULL : calloc(1, bytes);
+    if (h) {
+        memcpy(h->magic, TXN_IDX_MAGIC, 8);
+        h->version = TXN_IDX_VERSION;
+        h->binary = (uint32_t)rd.binary;
+        h->input_size = (uint64_t)st->st_size;
+        h->mtime_sec = (int64_t)st->st_mtim.tv_sec;
+        h->mtime_nsec = (int64_t)st->st_mtim.tv_nsec;
+        uint64_t *out = (uint64_t *)(h + 1);
+        for (int t = TXN_ATM; t <= TXN_TRANSFER; t++) {
+            h->count[t] = cnt[t];
+            if (cnt[t])
+                memcpy(out, pos[t], cnt[t] * sizeof(uint64_t));
+            out += cnt[t];
+        }
+    }
+    for (int t = 0; t < 4; t++)
+        free(pos[t]);
+    txn_reader_close(&rd);
+    if (!h) {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    ix->hdr = h;
+    ix->bytes = bytes;
+    txn_index_setup(ix);
+    return 0;
+}
+
+// 임시 파일에 쓴 뒤 rename 해서 다른 프로세스가 반쯤 쓴 사이드카를 보지 않게 한다.
+static inline void txn_index_save(const TxnIndex *ix, const char *side) {
+    char tmp[4096 + 32];
+    snprintf(tmp, sizeof(tmp), "%s.%d", side, (int)getpid());
+    FILE *f = fopen(tmp, "wb");
+    if (!f)
+        return;
+    size_t w = fwrite(ix->hdr, 1, ix->bytes, f);
+    if (fclose(f) != 0 || w != ix->bytes || rename(tmp, side) != 0)
+        unlink(tmp);
+}
+
+// 실패 시 -1 (errno 유지). 일반 파일이 아니거나 (stdin/파이프) 압축 파일이면 ESPIPE.
+static inline int txn_index_open(TxnIndex *ix, const char *path) {
+    memset(ix, 0, sizeof(*ix));
+    struct stat st;
+    if (strcmp(path, "-") == 0) {
+        errno = ESPIPE;
+        return -1;
+    }
+    if (stat(path, &st) < 0)
+        return -1;
+    if (!S_ISREG(st.st_mode)) {
+        errno = ESPIPE;
+        return -1;
+    }
+
+    char side[4096];
+    if (snprintf(side, sizeof(side), "%s%s", path, TXN_IDX_SUFFIX) >= (int)sizeof(side)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+
+    unsigned long long t0 = txn_now_ns();
+    if (!txn_index_load(ix, side, &st)) {
+        if (txn_index_build(ix, path, &st) < 0)
+            return -1;
+        txn_index_save(ix, side);
+    }
+    ix->build_sec = (txn_now_ns() - t0) / 1e9;
+    return 0;
+}
+
+// type 의 i 번째 레코드를 rd 에서 읽는다. rd 는 색인을 만든 것과 같은 입력이어야 한다.
+// 위치가 입력 밖이거나 그 자리에 그 type 의 레코드가 없으면 (색인을 만든 뒤 입력이
+// 바뀐 경우) 0.
+static inline int txn_index_read(const TxnReader *rd, const TxnIndex *ix, int type, size_t i,
+                                 TxnRecord *rec) {
+    uint64_t at = ix->pos[type][i];
+    int ok;
+    if (rd->binary) {
+        if (at >= rd->bin_count)
+            return 0;
+        *rec = rd->bin_recs[at];
+        txn_record_le(rec);
+        ok = 1;
+    } else {
+        if (at >= rd->size)
+            return 0;
+        txn_parse_line(rd->data + at, rd->data + rd->size, rec, &ok);
+    }
+    return ok && rec->type == type;
+}
+
+static inline void txn_index_close(TxnIndex *ix) {
+    if (ix->mapped)
+        munmap(ix->hdr, ix->bytes);
+    else
+        free(ix->hdr);
+    ix->hdr = NULL;
+}
+
+static inline void txn_index_report(const TxnIndex *ix) {
+    printf("🗂  색인%s: ATM %zu건 | 대출 %zu건 | 송금 %zu건 | %.6f 초\n",
+           ix->cached ? "(캐시)" : "(새로 생성)", ix->count[TXN_ATM], ix->count[TXN_LOAN],
+           ix->count[TXN_TRANSFER], ix->build_sec);
+}
+
+#endif
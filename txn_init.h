@@ -0,0 +1,120 @@
+// txn_init.h
+// 큰 사용자 테이블을 여러 스레드로 나눠 초기화한다 (first-touch 배치 포함)
+//
+// 사용자 번호 구간 [lo, hi) 를 스레드 수만큼 연속 구간으로 자르고 각 스레드가
+// 자기 구간만 채운다. 테이블을 txn_init_alloc() 으로 잡으면 페이지가 아직 붙지 않은
+// 상태라, 처음 쓰는 스레드(= 그 구간을 맡은 스레드)가 있는 노드에 페이지가 놓인다.
+// 가능하면 2MB 페이지로 잡는다 (txn_huge.h).
+// 구간 경계는 TXN_INIT_GRAIN 배수로 맞춰 두 스레드가 한 페이지를 나눠 쓰지 않게 한다.
+//
+//   TxnInit st;
+//   users = txn_init_alloc(&pages, txn_users_bytes(sizeof(UserInfo), max_users));
+//   txn_init_parallel(&st, 1, max_users + 1, init_users_range, users);
+//   ...
+//   txn_init_report(&st, wall_sec);   // 초기화와 처리 시간을 따로 출력
+//
+// 채우는 함수는 TXN_INIT_VEC 로 돌면 -O2 에서도 벡터화된다. -O2 의 벡터화 비용 모델은
+// 반복 수를 모르는 루프를 건너뛰므로, 상수 길이 블록과 남은 꼬리로 나눠 돈다.
+//
+//   TXN_INIT_VEC(i, begin, end, {
+//       users[i].user = (int)i;
+//       users[i].debt = 0;
+//   });
+
+#ifndef TXN_INIT_H
+#define TXN_INIT_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include "txn_parallel.h"
+#include "txn_huge.h"
+
+#define TXN_INIT_GRAIN 4096  // 구간 경계 단위 (원소 수)
+#define TXN_INIT_LANES 16    // TXN_INIT_VEC 블록 길이
+
+// [begin, end) 의 각 i 에 대해 본문을 실행한다. 본문은 i 번 원소만 써야 한다.
+#define TXN_INIT_VEC(i, begin, end, ...)                                          \
+    do {                                                                          \
+        size_t i##_b = (begin), i##_e = (end);                                    \
+        for (; i##_b + TXN_INIT_LANES <= i##_e; i##_b += TXN_INIT_LANES)          \
+            for (size_t i = i##_b; i < i##_b + TXN_INIT_LANES; i++)               \
+                __VA_ARGS__                                                       \
+        for (size_t i = i##_b; i < i##_e; i++)                                    \
+            __VA_ARGS__                                                           \
+    } while (0)
+
+typedef void (*TxnInitFn)(size_t begin, size_t end, void *ctx);
+
+typedef struct {
+    int threads;
+    double sec;
+    int snapshot;    // 1: 계산 대신 스냅샷을 매핑했다 (txn_snapshot.h)
+} TxnInit;
+
+typedef struct {
+    TxnInitFn fn;
+    void *ctx;
+    size_t begin, end;
+} TxnInitPart;
+
+// 페이지를 미리 붙이지 않는 익명 매핑. 실패 시 NULL (errno = ENOMEM).
+static inline void *txn_init_alloc(TxnHuge *h, size_t bytes) {
+    return txn_huge_alloc(h, bytes);
+}
+
+static inline void *txn_init_worker(void *arg) {
+    TxnInitPart *part = arg;
+    if (part->begin < part->end)
+        part->fn(part->begin, part->end, part->ctx);
+    return NULL;
+}
+
+// [lo, hi) 를 나눠 fn 을 부른다. 첫 구간은 호출한 스레드가 맡는다.
+// 스레드를 만들 수 없으면 남은 구간도 호출한 스레드가 채운다.
+static inline void txn_init_parallel(TxnInit *st, size_t lo, size_t hi, TxnInitFn fn, void *ctx) {
+    unsigned long long t0 = txn_now_ns();
+    int n = txn_parse_threads();
+    size_t total = hi > lo ? hi - lo : 0;
+    if ((size_t)n > total / TXN_INIT_GRAIN + 1)
+        n = (int)(total / TXN_INIT_GRAIN + 1);
+
+    TxnInitPart parts[TXN_PARSE_MAX_THREADS];
+    pthread_t tids[TXN_PARSE_MAX_THREADS];
+    int started[TXN_PARSE_MAX_THREADS] = {0};
+    // 경계는 lo 가 아니라 0 기준 TXN_INIT_GRAIN 배수에 둔다 (lo = 1 이어도 페이지에 맞게)
+    size_t base = lo - lo % TXN_INIT_GRAIN;
+    size_t per = ((hi - base) / n + TXN_INIT_GRAIN - 1) / TXN_INIT_GRAIN * TXN_INIT_GRAIN;
+    for (int i = 0; i < n; i++) {
+        size_t b = i ? base + per * i : lo, e = base + per * (i + 1);
+        parts[i] = (TxnInitPart){fn, ctx, b < hi ? b : hi, e < hi && i < n - 1 ? e : hi};
+    }
+
+    for (int i = 1; i < n; i++)
+        started[i] = pthread_create(&tids[i], NULL, txn_init_worker, &parts[i]) == 0;
+    txn_init_worker(&parts[0]);
+    for (int i = 1; i < n; i++) {
+        if (started[i])
+            pthread_join(tids[i], NULL);
+        else
+            txn_init_worker(&parts[i]);
+    }
+
+    st->threads = n;
+    st->snapshot = 0;
+    st->sec = (txn_now_ns() - t0) / 1e9;
+}
+
+// wall_sec 는 프로그램 전체 실행 시간. 처리 시간은 초기화를 뺀 나머지다.
+static inline void txn_init_report(const TxnInit *st, double wall_sec) {
+    if (st->snapshot) {
+        printf("🚀 초기화(스냅샷): %.6f 초 | ⚙️  처리: %.6f 초\n", st->sec, wall_sec - st->sec);
+        return;
+    }
+    printf("🚀 초기화(스레드 %d개): %.6f 초 | ⚙️  처리: %.6f 초\n", st->threads, st->sec,
+           wall_sec - st->sec);
+}
+
+#endif
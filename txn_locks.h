@@ -0,0 +1,186 @@
+// txn_locks.h
+// 공유 세그먼트 안에 두는 계좌별 줄무늬(striped) 잠금 표
+//
+// ATM / 송금 / 대출 처리기가 서로 다른 프로세스·스레드에서 같은 계좌를 고치므로
+// 잔액 갱신이 사라질 수 있다. 전역 잠금 하나 대신 사용자 번호로 고른 잠금 하나
+// (송금은 둘)만 잡게 해서, 다른 계좌를 고치는 처리기끼리는 서로 기다리지 않는다.
+//
+// 잠금은 PTHREAD_PROCESS_SHARED 뮤텍스이고 (txn_stream.h 와 같은 방식) 캐시 라인
+// 하나씩 차지하므로 이웃 줄무늬를 잡는 처리기끼리 라인을 나누지 않는다.
+// 표는 MAP_SHARED 세그먼트 안에 있어야 한다 (fork 된 자식과 exec 된 자식이 함께 쓴다).
+//
+//   size_t bytes = txn_locks_bytes(txn_locks_stripes(max_users));
+//   TxnLocks *locks = (TxnLocks *)(segment + off);
+//   txn_locks_init(locks, txn_locks_stripes(max_users));     // 세그먼트를 만든 쪽만
+//
+//   TxnLock *l = txn_locks_for(locks, user);                  // ATM, 대출
+//   txn_lock(l); ... txn_unlock(l);
+//
+//   TxnLock *held[2];                                         // 송금
+//   txn_locks_lock_pair(locks, sender, receiver, held);
+//   ... txn_locks_unlock_pair(held);
+//
+// 잠금 순서: 계좌 줄무늬 (주소가 작은 것 먼저) → ATM 자금 / 은행 자금 같은 전역 잠금.
+// 모든 처리기가 이 순서를 지키므로 교착이 생기지 않는다. 송금은 수신자가 어느 워커,
+// 어느 프로세스 몫이든 두 줄무늬를 함께 잡으므로 어떻게 나눠 돌려도 안전하다.
+//
+// 잠금마다 잡은 횟수, 바로 못 잡은 횟수, 기다린 시간을 잠금 자신이 센다. 잡은 뒤에
+// 고치므로 따로 동기화할 필요가 없고, 세그먼트 안에 있어 모든 프로세스의 몫이 모인다.
+// 대기 시간은 바로 못 잡았을 때만 재므로 경합이 없으면 시계를 읽지 않는다.
+
+#ifndef TXN_LOCKS_H
+#define TXN_LOCKS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+
+#define TXN_LOCK_LINE        64
+#define TXN_LOCK_MAX_STRIPES 1024   // 이보다 많아도 충돌이 거의 줄지 않고 표만 커진다
+
+// 뮤텍스(40 B)와 통계가 캐시 라인 하나에 들어간다
+typedef struct {
+    _Alignas(TXN_LOCK_LINE) pthread_mutex_t m;
+    uint64_t acquired;     // 잡은 횟수
+    uint64_t contended;    // 바로 못 잡고 기다린 횟수
+    uint64_t wait_ns;      // 기다린 시간 합계
+} TxnLock;
+
+typedef struct {
+    unsigned long long acquired, contended, wait_ns;
+} TxnLockStats;
+
+typedef struct {
+    uint32_t stripes;   // 2의 거듭제곱
+    uint32_t mask;
+    TxnLock stripe[];
+} TxnLocks;
+
+// 사용자 수에 맞는 줄무늬 수: users + 1 이상인 2의 거듭제곱, 최대 TXN_LOCK_MAX_STRIPES
+static inline unsigned txn_locks_stripes(size_t users) {
+    unsigned s = 1;
+    while (s < TXN_LOCK_MAX_STRIPES && s <= users)
+        s <<= 1;
+    return s;
+}
+
+static inline size_t txn_locks_bytes(unsigned stripes) {
+    return sizeof(TxnLocks) + (size_t)stripes * sizeof(TxnLock);
+}
+
+// 공유 세그먼트 안의 잠금 하나를 프로세스 공유로 초기화한다. 실패 시 -1 (errno 설정).
+static inline int txn_lock_init(TxnLock *l) {
+    pthread_mutexattr_t ma;
+    pthread_mutexattr_init(&ma);
+    int rc = pthread_mutexattr_setpshared(&ma, PTHREAD_PROCESS_SHARED);
+    if (rc == 0)
+        rc = pthread_mutex_init(&l->m, &ma);
+    pthread_mutexattr_destroy(&ma);
+    if (rc != 0) {
+        errno = rc;
+        return -1;
+    }
+    l->acquired = l->contended = l->wait_ns = 0;
+    return 0;
+}
+
+// stripes 는 2의 거듭제곱이어야 한다 (txn_locks_stripes). 실패 시 -1 (errno 설정).
+static inline int txn_locks_init(TxnLocks *t, unsigned stripes) {
+    if (stripes == 0 || (stripes & (stripes - 1)) != 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    t->stripes = stripes;
+    t->mask = stripes - 1;
+    for (unsigned i = 0; i < stripes; i++)
+        if (txn_lock_init(&t->stripe[i]) < 0)
+            return -1;
+    return 0;
+}
+
+static inline unsigned long long txn_lock_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+}
+
+static inline void txn_lock(TxnLock *l) {
+    if (pthread_mutex_trylock(&l->m) != 0) {
+        unsigned long long t0 = txn_lock_now_ns();
+        pthread_mutex_lock(&l->m);
+        l->contended++;
+        l->wait_ns += txn_lock_now_ns() - t0;
+    }
+    l->acquired++;
+}
+
+static inline void txn_unlock(TxnLock *l) {
+    pthread_mutex_unlock(&l->m);
+}
+
+// 사용자 번호를 그대로 줄무늬로 쓴다. 이웃 사용자는 서로 다른 줄무늬에 간다.
+static inline TxnLock *txn_locks_for(TxnLocks *t, int user) {
+    return &t->stripe[(uint32_t)user & t->mask];
+}
+
+// 두 사용자의 줄무늬를 잡을 순서대로 *first, *second 에 준다. 같은 줄무늬면 (자기 자신에게
+// 보내는 송금 포함) *second = NULL 이라 한 번만 잡는다.
+static inline void txn_locks_pair(TxnLocks *t, int a, int b, TxnLock **first, TxnLock **second) {
+    TxnLock *la = txn_locks_for(t, a), *lb = txn_locks_for(t, b);
+    if (la == lb) {
+        *first = la;
+        *second = NULL;
+    } else if (la < lb) {
+        *first = la;
+        *second = lb;
+    } else {
+        *first = lb;
+        *second = la;
+    }
+}
+
+// 두 사용자의 줄무늬를 정해진 순서로 잡는다. 잡은 잠금은 held[0], held[1] (없으면 NULL).
+static inline void txn_locks_lock_pair(TxnLocks *t, int a, int b, TxnLock *held[2]) {
+    txn_locks_pair(t, a, b, &held[0], &held[1]);
+    txn_lock(held[0]);
+    if (held[1])
+        txn_lock(held[1]);
+}
+
+static inline void txn_locks_unlock_pair(TxnLock *held[2]) {
+    if (held[1])
+        txn_unlock(held[1]);
+    txn_unlock(held[0]);
+}
+
+// 모든 처리기가 끝난 뒤에 부른다 (잠금을 잡지 않고 읽는다)
+static inline void txn_lock_stats_add(TxnLockStats *st, const TxnLock *l) {
+    st->acquired += l->acquired;
+    st->contended += l->contended;
+    st->wait_ns += l->wait_ns;
+}
+
+static inline TxnLockStats txn_locks_stats(const TxnLocks *t) {
+    TxnLockStats st = {0, 0, 0};
+    for (unsigned i = 0; i < t->stripes; i++)
+        txn_lock_stats_add(&st, &t->stripe[i]);
+    return st;
+}
+
+static inline void txn_lock_stats_report(const TxnLockStats *st, const char *label) {
+    printf("🔒 %s 잠금 대기: 잡기 %llu회 | 경합 %llu회 (%.2f%%) | 대기 %.3f ms (경합당 %.1f us)\n",
+           label, st->acquired, st->contended,
+           st->acquired ? 100.0 * st->contended / st->acquired : 0.0, st->wait_ns / 1e6,
+           st->contended ? st->wait_ns / 1e3 / st->contended : 0.0);
+}
+
+static inline void txn_locks_report(const TxnLocks *t, const char *label) {
+    printf("🔒 %s 잠금: 줄무늬 %u개 × %zu B = %.1f KB (프로세스 공유)\n", label, t->stripes,
+           sizeof(TxnLock), txn_locks_bytes(t->stripes) / 1024.0);
+    fflush(stdout);
+}
+
+#endif
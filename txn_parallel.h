@@ -0,0 +1,245 @@
+// txn_parallel.h
+// 입력을 여러 스레드로 나눠 파싱하는 병렬 파서
+//
+// 매핑된 입력을 스레드 수만큼 바이트 구간으로 자르고, 각 경계를 다음 '\n' 뒤로 맞춘다.
+// 각 스레드는 자기 구간을 type 별 지역 배열로 파싱하고, 모두 끝나면 구간 순서대로
+// 최종 배열에 이어 붙인다. 결과는 type 별로 파일 순서가 유지되며, seq 로 type 간
+// 순서도 복원할 수 있다 (순차 실행이 필요한 엔진용).
+//
+//   TxnParsed parsed;
+//   if (txn_parse_parallel(path, txn_parse_threads(), &parsed) < 0) { perror(...); }
+//   parsed.recs[TXN_LOAN][0 .. parsed.count[TXN_LOAN])
+//   txn_parsed_free(&parsed);
+//
+// stdin/파이프 입력은 나눌 수 없으므로 한 스레드가 처음부터 끝까지 읽는다.
+
+#ifndef TXN_PARALLEL_H
+#define TXN_PARALLEL_H
+
+#include <stdlib.h>
+#include <pthread.h>
+#include "txn_reader.h"
+
+#define TXN_PARSE_MAX_THREADS 64
+
+typedef struct {
+    TxnRecord *recs[4];  // type 별 레코드 (파일 순서)
+    uint64_t *seq[4];    // 각 레코드가 입력에서 몇 번째 레코드인지
+    size_t count[4];
+    size_t total;
+    size_t bytes;
+    int threads;
+    double parse_sec;
+} TxnParsed;
+
+typedef struct {
+    TxnReader *rd;
+    size_t begin, end;       // 텍스트: 바이트 구간, 바이너리: 레코드 구간
+    TxnRecord *recs[4];
+    uint64_t *local_no[4];   // 구간 안에서의 순번
+    size_t count[4], cap[4];
+    size_t total;
+    size_t out_off[4];       // 최종 배열에서의 시작 위치
+    uint64_t seq_base;       // 앞 구간들의 레코드 수 합
+    TxnParsed *out;
+    pthread_barrier_t *barrier;
+    int id;
+    int failed;
+} TxnChunk;
+
+static inline int txn_parse_threads(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n < 1) n = 1;
+    if (n > TXN_PARSE_MAX_THREADS) n = TXN_PARSE_MAX_THREADS;
+    return (int)n;
+}
+
+// 텍스트 구간 경계 pos 를 다음 줄의 시작으로 맞춘다.
+static inline size_t txn_align_line(const TxnReader *rd, size_t pos) {
+    if (pos == 0 || pos >= rd->size)
+        return pos >= rd->size ? rd->size : 0;
+    if (rd->data[pos - 1] == '\n')
+        return pos;
+    const char *nl = memchr(rd->data + pos, '\n', rd->size - pos);
+    return nl ? (size_t)(nl - rd->data) + 1 : rd->size;
+}
+
+static inline int txn_chunk_push(TxnChunk *c, const TxnRecord *rec) {
+    int t = rec->type;
+    if (c->count[t] == c->cap[t]) {
+        size_t cap = c->cap[t] ? c->cap[t] * 2 : 1024;
+        TxnRecord *r = realloc(c->recs[t], cap * sizeof(TxnRecord));
+        uint64_t *n = realloc(c->local_no[t], cap * sizeof(uint64_t));
+        if (!r || !n) {
+            c->recs[t] = r ? r : c->recs[t];
+            c->local_no[t] = n ? n : c->local_no[t];
+            return -1;
+        }
+        c->recs[t] = r;
+        c->local_no[t] = n;
+        c->cap[t] = cap;
+    }
+    c->recs[t][c->count[t]] = *rec;
+    c->local_no[t][c->count[t]++] = c->total++;
+    return 0;
+}
+
+static inline void *txn_chunk_worker(void *arg) {
+    TxnChunk *c = arg;
+    TxnChunk *all = c - c->id;
+    TxnParsed *out = c->out;
+    TxnReader *rd = c->rd;
+    TxnRecord rec;
+
+    // 1단계: 자기 구간을 지역 배열로 파싱
+    if (rd->stream) {
+        while (!c->failed && txn_reader_next(rd, &rec)) {
+            if (txn_chunk_push(c, &rec) < 0)
+                c->failed = 1;
+        }
+    } else if (rd->binary) {
+        for (size_t i = c->begin; i < c->end && !c->failed; i++) {
+            rec = rd->bin_recs[i];
+            txn_record_le(&rec);
+            if (rec.type >= TXN_ATM && rec.type <= TXN_TRANSFER && txn_chunk_push(c, &rec) < 0)
+                c->failed = 1;
+        }
+    } else {
+        const char *p = rd->data + c->begin;
+        const char *end = rd->data + c->end;
+        int ok;
+        while (p < end && !c->failed) {
+            p = txn_parse_line(p, end, &rec, &ok);
+            if (ok && txn_chunk_push(c, &rec) < 0)
+                c->failed = 1;
+        }
+    }
+
+    // 2단계: 0번 스레드가 전체 크기를 정해 최종 배열을 잡는다
+    pthread_barrier_wait(c->barrier);
+    if (c->id == 0) {
+        int failed = 0;
+        uint64_t base = 0;
+        size_t off[4] = {0};
+        for (int i = 0; i < out->threads; i++) {
+            failed |= all[i].failed;
+            all[i].seq_base = base;
+            base += all[i].total;
+            for (int t = TXN_ATM; t <= TXN_TRANSFER; t++) {
+                all[i].out_off[t] = off[t];
+                off[t] += all[i].count[t];
+            }
+        }
+        out->total = (size_t)base;
+        for (int t = TXN_ATM; t <= TXN_TRANSFER && !failed; t++) {
+            out->count[t] = off[t];
+            out->recs[t] = malloc((off[t] ? off[t] : 1) * sizeof(TxnRecord));
+            out->seq[t] = malloc((off[t] ? off[t] : 1) * sizeof(uint64_t));
+            if (!out->recs[t] || !out->seq[t])
+                failed = 1;
+        }
+        for (int i = 0; i < out->threads; i++)
+            all[i].failed = failed;
+    }
+    pthread_barrier_wait(c->barrier);
+
+    // 3단계: 각자 자기 몫을 최종 위치로 복사 (구간 순서 = 파일 순서)
+    if (!c->failed) {
+        for (int t = TXN_ATM; t <= TXN_TRANSFER; t++) {
+            size_t n = c->count[t];
+            if (!n)
+                continue;
+            memcpy(out->recs[t] + c->out_off[t], c->recs[t], n * sizeof(TxnRecord));
+            uint64_t *seq = out->seq[t] + c->out_off[t];
+            for (size_t i = 0; i < n; i++)
+                seq[i] = c->seq_base + c->local_no[t][i];
+        }
+    }
+    for (int t = 0; t < 4; t++) {
+        free(c->recs[t]);
+        free(c->local_no[t]);
+    }
+    return NULL;
+}
+
+static inline void txn_parsed_free(TxnParsed *p) {
+    for (int t = 0; t < 4; t++) {
+        free(p->recs[t]);
+        free(p->seq[t]);
+        p->recs[t] = NULL;
+        p->seq[t] = NULL;
+    }
+}
+
+// 실패 시 -1 (errno 유지).
+static inline int txn_parse_parallel(const char *path, int nthreads, TxnParsed *out) {
+    memset(out, 0, sizeof(*out));
+
+    // 구간을 나누려면 파일이 매핑돼 있어야 한다. txn_reader_open 은 큰 파일을 aio 스트림으로
+    // 열어 구간 없이 한 스레드로 돌게 만들므로 색인·큐 빌더처럼 mmap 으로 연다.
+    // aio 선읽기는 순차 스트림 리더(txn_reader_open)에만 쓴다.
+    TxnReader rd;
+    if (txn_reader_open_mmap(&rd, path) < 0)
+        return -1;
+
+    unsigned long long t0 = txn_now_ns();
+    size_t units = rd.stream ? 0 : rd.binary ? rd.bin_count : rd.size;
+    if (nthreads < 1) nthreads = 1;
+    if (nthreads > TXN_PARSE_MAX_THREADS) nthreads = TXN_PARSE_MAX_THREADS;
+    // 너무 작은 입력은 스레드를 다 쓰지 않는다 (구간당 최소 64KB / 4096건)
+    size_t min_unit = rd.binary ? 4096 : 65536;
+    if ((size_t)nthreads > units / min_unit + 1)
+        nthreads = (int)(units / min_unit + 1);
+
+    TxnChunk chunks[TXN_PARSE_MAX_THREADS];
+    pthread_t tids[TXN_PARSE_MAX_THREADS];
+    pthread_barrier_t barrier;
+    pthread_barrier_init(&barrier, NULL, (unsigned)nthreads);
+    memset(chunks, 0, sizeof(chunks));
+    out->threads = nthreads;
+
+    for (int i = 0; i < nthreads; i++) {
+        size_t b = units / nthreads * i;
+        size_t e = i == nthreads - 1 ? units : units / nthreads * (i + 1);
+        if (!rd.binary) {
+            b = txn_align_line(&rd, b);
+            e = txn_align_line(&rd, e);
+        }
+        chunks[i] = (TxnChunk){.rd = &rd, .begin = b, .end = e, .out = out,
+                               .barrier = &barrier, .id = i};
+    }
+    for (int i = 1; i < nthreads; i++) {
+        int rc = pthread_create(&tids[i], NULL, txn_chunk_worker, &chunks[i]);
+        if (rc != 0) {
+            // barrier 는 nthreads 개를 기다리므로 일부만 띄운 채로는 끝낼 수 없다
+            errno = rc;
+            perror("파싱 스레드 생성 실패");
+            exit(1);
+        }
+    }
+    txn_chunk_worker(&chunks[0]);
+    for (int i = 1; i < nthreads; i++)
+        pthread_join(tids[i], NULL);
+    pthread_barrier_destroy(&barrier);
+
+    out->bytes = rd.size;
+    out->parse_sec = (txn_now_ns() - t0) / 1e9;
+    int err = rd.err;   // 스트림 입력의 읽기 오류 (txn_reader_fail 이 이미 알렸다)
+    txn_reader_close(&rd);
+
+    if (chunks[0].failed || err) {
+        txn_parsed_free(out);
+        errno = err ? err : ENOMEM;
+        return -1;
+    }
+    return 0;
+}
+
+static inline void txn_parsed_report(const TxnParsed *p) {
+    double mb = p->bytes / (1024.0 * 1024.0);
+    printf("📥 병렬 파싱(%d 스레드): %zu건 | %.2f MB | %.6f 초 | %.1f MB/s\n",
+           p->threads, p->total, mb, p->parse_sec,
+           p->parse_sec > 0 ? mb / p->parse_sec : 0.0);
+}
+
+#endif
@@ -0,0 +1,71 @@
+// txn_partition.h
+// user % parts 로 일을 나누는 워커들을 위한 계좌 배치 (false sharing 제거)
+//
+// 계좌를 사용자 번호 순서대로 두면 이웃한 사용자 2k, 2k+1 이 한 캐시 라인에 있어,
+// 서로 독립이어야 할 두 워커가 같은 라인을 번갈아 써서 라인이 코어 사이를 오간다.
+// 여기서는 워커 w 가 맡는 사용자 w, w + parts, w + 2·parts, ... 를 한 구간에 모으고
+// 구간마다 캐시 라인 경계에서 시작하게 한다. 워커가 자기 사용자만 쓰면 라인을 나누지 않는다.
+// (송금 수신자처럼 다른 워커의 계좌를 쓰는 경우는 진짜 공유라 그대로 남는다.)
+//
+//   TxnPartition pt;
+//   size_t bytes = txn_part_layout(&pt, max_users, num_workers, sizeof(AccountInfo));
+//   AccountInfo *info = txn_part_at(&pt, db->accounts, user);
+//
+// 여러 워커가 함께 쓰는 전역 값(ATM 자금 등)은 _Alignas(TXN_PART_LINE) 로 따로 둔다.
+
+#ifndef TXN_PARTITION_H
+#define TXN_PARTITION_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#define TXN_PART_LINE 64
+
+typedef struct {
+    uint32_t parts;
+    uint32_t elem;
+    int shift;             // parts 가 2의 거듭제곱이면 log2(parts), 아니면 -1 (나눗셈 사용)
+    uint64_t per_part;     // 구간당 칸 수 (user / parts 의 최댓값 + 1)
+    uint64_t part_bytes;   // 구간 크기 (캐시 라인 배수)
+} TxnPartition;
+
+// 사용자 0..users 를 parts 구간으로 나눈 배치를 정하고 전체 바이트 수를 돌려준다.
+static inline size_t txn_part_layout(TxnPartition *pt, size_t users, unsigned parts, size_t elem) {
+    if (parts < 1)
+        parts = 1;
+    pt->parts = parts;
+    pt->elem = (uint32_t)elem;
+    pt->shift = -1;
+    if ((parts & (parts - 1)) == 0)
+        pt->shift = __builtin_ctz(parts);
+    pt->per_part = users / parts + 1;
+    pt->part_bytes = (pt->per_part * elem + TXN_PART_LINE - 1) & ~(uint64_t)(TXN_PART_LINE - 1);
+    return (size_t)(pt->part_bytes * parts);
+}
+
+// user 를 맡는 워커
+static inline unsigned txn_part_owner(const TxnPartition *pt, int user) {
+    return (unsigned)user % pt->parts;
+}
+
+// 계좌마다 불리므로 워커 수가 2의 거듭제곱이면 나눗셈 대신 시프트/마스크로 구간을 찾는다
+static inline void *txn_part_at(const TxnPartition *pt, void *base, int user) {
+    unsigned u = (unsigned)user, part, slot;
+    if (pt->shift >= 0) {
+        part = u & (pt->parts - 1);
+        slot = u >> pt->shift;
+    } else {
+        part = u % pt->parts;
+        slot = u / pt->parts;
+    }
+    return (char *)base + (size_t)part * pt->part_bytes + (size_t)slot * pt->elem;
+}
+
+static inline void txn_part_report(const TxnPartition *pt, const char *label) {
+    printf("🧱 %s 배치: 워커 %u개 × %llu칸 | 구간 %llu B (캐시 라인 경계)\n", label, pt->parts,
+           (unsigned long long)pt->per_part, (unsigned long long)pt->part_bytes);
+    fflush(stdout);
+}
+
+#endif
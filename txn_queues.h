@@ -0,0 +1,258 @@
+// txn_queues.h
+// 부모가 입력을 한 번만 파싱해 type 별 레코드 배열을 공유 메모리로 넘긴다.
+//
+// 부모는 txn_queues_build() 로 입력을 파싱해 memfd 세그먼트에 담는다.
+// fork 된 자식은 매핑을 그대로 물려받고, exec 된 자식은 환경변수
+// TXN_QUEUES_FD 로 전달된 fd 를 txn_queues_load() 가 알아서 붙인다.
+// 환경변수가 없으면 (자식을 단독 실행한 경우) 직접 파싱한다.
+// memfd 는 CLOEXEC 로 만들므로, 세그먼트를 쓸 자식만 exec 직전에 txn_queues_share() 로
+// 넘긴다. 넘기지 않은 자식은 fd 를 붙이지 못하고 직접 파싱한다.
+//
+// 일부 type 만 필요한 쪽은 txn_queues_build_types() 로 그 type 만 담는다.
+// 이때는 txn_index 사이드카로 해당 줄만 찾아 해석하므로 나머지 줄은 읽지 않는다.
+// 세그먼트의 types 에 필요한 type 이 없으면 txn_queues_load() 가 직접 만든다.
+//
+//   TxnQueues *q = txn_queues_load(argv[1], 1u << TXN_LOAN);
+//   size_t n;
+//   const TxnRecord *loans = txn_queue(q, TXN_LOAN, &n);
+//
+//   if (fork() == 0) { txn_queues_share(q); execl(...); }   // 부모: 대출 자식에게 넘긴다
+//
+// 한 프로세스가 여러 type 을 처리할 때는 TxnQueueIter 로 파일 순서를 복원한다.
+
+#ifndef TXN_QUEUES_H
+#define TXN_QUEUES_H
+
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include "txn_parallel.h"
+#include "txn_index.h"
+
+#define TXN_QUEUES_ENV   "TXN_QUEUES_FD"
+#define TXN_QUEUES_MAGIC 0x5158544eU  // "NTXQ"
+#define TXN_QUEUES_ALL   ((1u << TXN_ATM) | (1u << TXN_LOAN) | (1u << TXN_TRANSFER))
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC      0x0001U
+#endif
+
+// ---------- 세그먼트 레이아웃 ----------
+// [TxnQueues][ATM 레코드][대출 레코드][송금 레코드][ATM seq][대출 seq][송금 seq]
+// seq 는 레코드의 입력 내 순서 키 (type 간 순서 복원용). 전체 파싱이면 레코드 번호,
+// 색인으로 만들었으면 줄 오프셋(바이너리는 레코드 번호)이라 값은 달라도 순서는 같다.
+
+typedef struct {
+    uint32_t magic;
+    uint32_t types;   // 담긴 type 들 ((1 << type) 의 OR)
+    int32_t fd;       // memfd 번호. 넘겨받은 자식도 같은 번호로 갖고 있다
+    uint64_t bytes;
+    uint64_t count[4];
+    uint64_t rec_off[4];
+    uint64_t seq_off[4];
+} TxnQueues;
+
+static inline const TxnRecord *txn_queue(const TxnQueues *q, int type, size_t *n) {
+    *n = q->count[type];
+    return (const TxnRecord *)((const char *)q + q->rec_off[type]);
+}
+
+static inline const uint64_t *txn_queue_seq(const TxnQueues *q, int type) {
+    return (const uint64_t *)((const char *)q + q->seq_off[type]);
+}
+
+// ---------- 생성 (부모) ----------
+
+// 건수에 맞는 memfd 세그먼트를 잡고 오프셋을 채운다. 내용은 호출자가 채운다.
+static inline TxnQueues *txn_queues_create(const size_t cnt[4], unsigned types) {
+    size_t total = cnt[TXN_ATM] + cnt[TXN_LOAN] + cnt[TXN_TRANSFER];
+    size_t bytes = sizeof(TxnQueues) + total * (sizeof(TxnRecord) + sizeof(uint64_t));
+
+    // CLOEXEC: 세그먼트를 쓰는 자식에게만 txn_queues_share() 로 넘긴다.
+    // _GNU_SOURCE 순서에 묶이지 않도록 syscall 로 부른다.
+    int fd = (int)syscall(SYS_memfd_create, "txn_queues", MFD_CLOEXEC);
+    if (fd < 0)
+        return NULL;
+    void *p = MAP_FAILED;
+    if (ftruncate(fd, (off_t)bytes) == 0)
+        p = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        close(fd);
+        return NULL;
+    }
+
+    TxnQueues *q = p;
+    q->magic = TXN_QUEUES_MAGIC;
+    q->types = types;
+    q->fd = fd;
+    q->bytes = bytes;
+    uint64_t off = sizeof(TxnQueues);
+    for (int t = TXN_ATM; t <= TXN_TRANSFER; t++) {
+        q->count[t] = cnt[t];
+        q->rec_off[t] = off;
+        off += cnt[t] * sizeof(TxnRecord);
+    }
+    for (int t = TXN_ATM; t <= TXN_TRANSFER; t++) {
+        q->seq_off[t] = off;
+        off += cnt[t] * sizeof(uint64_t);
+    }
+
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%d", fd);
+    setenv(TXN_QUEUES_ENV, buf, 1);
+    return q;
+}
+
+// fork 된 자식이 exec 직전에 부른다: 세그먼트 fd 를 exec 너머로 넘긴다. 실패 시 -1.
+static inline int txn_queues_share(const TxnQueues *q) {
+    return fcntl(q->fd, F_SETFD, 0);
+}
+
+static inline void txn_queues_release(TxnQueues *q) {
+    if (q) {
+        int fd = q->fd;
+        munmap(q, q->bytes);
+        close(fd);
+    }
+}
+
+static inline TxnQueues *txn_queues_build(const char *path) {
+    TxnParsed parsed;
+    if (txn_parse_parallel(path, txn_parse_threads(), &parsed) < 0)
+        return NULL;
+    txn_parsed_report(&parsed);
+
+    TxnQueues *q = txn_queues_create(parsed.count, TXN_QUEUES_ALL);
+    if (q) {
+        for (int t = TXN_ATM; t <= TXN_TRANSFER; t++) {
+            if (!parsed.count[t])
+                continue;
+            memcpy((char *)q + q->rec_off[t], parsed.recs[t], parsed.count[t] * sizeof(TxnRecord));
+            memcpy((char *)q + q->seq_off[t], parsed.seq[t], parsed.count[t] * sizeof(uint64_t));
+        }
+    }
+
+    txn_parsed_free(&parsed);
+    return q;
+}
+
+// mask 에 든 type 만 담는다. 색인(사이드카)으로 해당 줄만 해석하며,
+// 색인을 쓸 수 없는 입력(stdin 등)이면 전체를 파싱한다.
+static inline TxnQueues *txn_queues_build_types(const char *path, unsigned mask) {
+    mask &= TXN_QUEUES_ALL;
+    TxnIndex ix;
+    if (mask == TXN_QUEUES_ALL || txn_index_open(&ix, path) < 0)
+        return txn_queues_build(path);
+    txn_index_report(&ix);
+
+    TxnReader rd;
+    if (txn_reader_open_mmap(&rd, path) < 0) {
+        txn_index_close(&ix);
+        return NULL;
+    }
+    if (rd.stream || rd.binary != (int)ix.hdr->binary || rd.size != ix.hdr->input_size) {
+        // 색인을 확인한 뒤 파일이 바뀐 경우: 전체 파싱으로 돌아간다
+        txn_reader_close(&rd);
+        txn_index_close(&ix);
+        return txn_queues_build(path);
+    }
+    madvise((void *)rd.data, rd.size, MADV_RANDOM);
+
+    size_t cnt[4] = {0};
+    for (int t = TXN_ATM; t <= TXN_TRANSFER; t++)
+        cnt[t] = (mask & (1u << t)) ? ix.count[t] : 0;
+
+    unsigned long long t0 = txn_now_ns();
+    TxnQueues *q = txn_queues_create(cnt, mask);
+    int stale = 0;
+    if (q) {
+        for (int t = TXN_ATM; t <= TXN_TRANSFER && !stale; t++) {
+            TxnRecord *recs = (TxnRecord *)((char *)q + q->rec_off[t]);
+            uint64_t *seq = (uint64_t *)((char *)q + q->seq_off[t]);
+            for (size_t i = 0; i < cnt[t] && !stale; i++) {
+                stale = !txn_index_read(&rd, &ix, t, i, &recs[i]);
+                seq[i] = ix.pos[t][i];
+            }
+        }
+        if (!stale)
+            printf("📥 색인 파싱: %zu건 | %.6f 초\n",
+                   cnt[TXN_ATM] + cnt[TXN_LOAN] + cnt[TXN_TRANSFER], (txn_now_ns() - t0) / 1e9);
+    }
+
+    txn_reader_close(&rd);
+    txn_index_close(&ix);
+    if (stale) {
+        // 색인이 입력과 어긋난다 (확인과 매핑 사이에 파일이 바뀜): 전체 파싱으로 돌아간다
+        txn_queues_release(q);
+        return txn_queues_build(path);
+    }
+    return q;
+}
+
+// ---------- 연결 (exec 된 자식) ----------
+
+// 세그먼트에 mask 의 type 이 모두 있어야 붙는다.
+static inline TxnQueues *txn_queues_attach(unsigned mask) {
+    const char *env = getenv(TXN_QUEUES_ENV);
+    if (!env)
+        return NULL;
+
+    int fd = atoi(env);
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(TxnQueues))
+        return NULL;
+
+    void *p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED)
+        return NULL;
+
+    TxnQueues *q = p;
+    if (q->magic != TXN_QUEUES_MAGIC || q->bytes != (uint64_t)st.st_size || q->fd != fd ||
+        (q->types & mask) != (mask & TXN_QUEUES_ALL)) {
+        munmap(p, (size_t)st.st_size);
+        return NULL;
+    }
+    return q;
+}
+
+// 부모가 넘긴 세그먼트에 mask 의 type 이 있으면 붙이고, 없으면 그 type 만 직접 만든다.
+static inline TxnQueues *txn_queues_load(const char *path, unsigned mask) {
+    TxnQueues *q = txn_queues_attach(mask);
+    return q ? q : txn_queues_build_types(path, mask);
+}
+
+// ---------- 여러 type 을 파일 순서대로 ----------
+
+typedef struct {
+    const TxnQueues *q;
+    unsigned mask;   // (1 << type) 의 OR
+    size_t pos[4];
+} TxnQueueIter;
+
+static inline void txn_queue_iter_init(TxnQueueIter *it, const TxnQueues *q, unsigned mask) {
+    memset(it, 0, sizeof(*it));
+    it->q = q;
+    it->mask = mask;
+}
+
+static inline int txn_queue_iter_next(TxnQueueIter *it, TxnRecord *rec) {
+    int best = 0;
+    uint64_t best_seq = UINT64_MAX;
+    for (int t = TXN_ATM; t <= TXN_TRANSFER; t++) {
+        if (!(it->mask & (1u << t)) || it->pos[t] >= it->q->count[t])
+            continue;
+        uint64_t s = txn_queue_seq(it->q, t)[it->pos[t]];
+        if (s < best_seq) {
+            best_seq = s;
+            best = t;
+        }
+    }
+    if (!best)
+        return 0;
+
+    size_t n;
+    *rec = txn_queue(it->q, best, &n)[it->pos[best]++];
+    return 1;
+}
+
+#endif
@@ -0,0 +1,213 @@
+// txn_snapshot.h
+// 초기화가 끝난 계좌/사용자 테이블을 파일로 떠 두고 다음 실행에서 바로 매핑한다
+//
+// 500만 명 테이블을 매번 다시 계산하는 대신, 한 번 만든 테이블을 스냅샷 파일로 쓴다.
+// 다음 실행은 파일을 MAP_PRIVATE 로 매핑하므로 읽기는 페이지 캐시를 그대로 쓰고,
+// 거래로 바뀌는 페이지만 그 프로세스 안에서 복사된다 (파일은 바뀌지 않는다).
+//
+//   void *p = txn_snapshot_map(&snap, "n_a_pra.snap", &spec);
+//   if (!p) { printf("%s\n", txn_snapshot_why(errno)); 전체 초기화; }
+//   ...
+//   txn_snapshot_save("n_a_pra.snap", &spec, table);   // --build-snapshot
+//
+// 헤더의 종류 이름, 건수, 원소 크기, 호출자가 정한 param 이 하나라도 다르면 오래된
+// 스냅샷으로 보고 (ESTALE), 내용 검사합이 다르면 깨진 파일로 본다 (EBADMSG).
+// 헤더는 한 페이지를 차지해 내용이 페이지 경계에서 시작한다. 내용 길이는 8의 배수.
+
+#ifndef TXN_SNAPSHOT_H
+#define TXN_SNAPSHOT_H
+
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "txn_reader.h"
+
+#define TXN_SNAP_MAGIC   "TXNSNAP\0"
+#define TXN_SNAP_VERSION 1
+#define TXN_SNAP_HEADER  4096  // 헤더 자리 (내용은 이 오프셋부터)
+
+typedef struct {
+    char     magic[8];
+    uint32_t version;
+    uint32_t header_bytes;
+    char     kind[32];       // 테이블 종류 ("n_a_pra 계좌" 등)
+    uint64_t count;          // 원소 수
+    uint64_t elem;           // 원소 하나의 크기 (열 저장소면 열 크기 합)
+    uint64_t param;          // 기본값 등 내용을 바꾸는 설정의 지문
+    uint64_t payload_bytes;
+    uint64_t checksum;       // 내용 검사합 (txn_snapshot_sum)
+    int64_t  created;        // 만든 시각 (time(NULL))
+} TxnSnapHeader;
+
+// 호출자가 기대하는 테이블 모양
+typedef struct {
+    const char *kind;
+    uint64_t count;
+    uint64_t elem;
+    uint64_t param;
+    uint64_t payload_bytes;
+} TxnSnapSpec;
+
+typedef struct {
+    void *base;              // 파일 전체 매핑
+    size_t bytes;
+    double load_sec;
+    int64_t created;
+} TxnSnapshot;
+
+// 64비트 단어 네 줄기로 나눠 섞는 검사합. 길이는 8의 배수여야 한다.
+static inline uint64_t txn_snapshot_sum(const void *p, size_t bytes) {
+    const uint64_t *w = p;
+    size_t n = bytes / 8;
+    uint64_t h0 = 0x9e3779b97f4a7c15ULL, h1 = 0xc2b2ae3d27d4eb4fULL;
+    uint64_t h2 = 0x165667b19e3779f9ULL, h3 = 0x27d4eb2f165667c5ULL;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        h0 = (h0 ^ w[i]) * 0x100000001b3ULL;
+        h1 = (h1 ^ w[i + 1]) * 0x100000001b3ULL;
+        h2 = (h2 ^ w[i + 2]) * 0x100000001b3ULL;
+        h3 = (h3 ^ w[i + 3]) * 0x100000001b3ULL;
+    }
+    for (; i < n; i++)
+        h0 = (h0 ^ w[i]) * 0x100000001b3ULL;
+    uint64_t h = h0 ^ (h1 << 1 | h1 >> 63) ^ (h2 << 2 | h2 >> 62) ^ (h3 << 3 | h3 >> 61);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h ^ (uint64_t)bytes;
+}
+
+static inline const char *txn_snapshot_why(int err) {
+    switch (err) {
+    case ENOENT:  return "스냅샷 없음";
+    case ESTALE:  return "스냅샷이 현재 설정과 다름";
+    case EBADMSG: return "스냅샷 검사합 불일치";
+    default:      return strerror(err);
+    }
+}
+
+// 헤더만 읽어 종류가 kind 인 스냅샷의 원소 수를 돌려준다. 없거나 다른 종류면 0.
+// 사용자 수를 정하지 않고 실행할 때 스냅샷을 만든 때의 사용자 수를 따르는 데 쓴다.
+static inline uint64_t txn_snapshot_count(const char *path, const char *kind) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return 0;
+    TxnSnapHeader h;
+    int ok = pread(fd, &h, sizeof(h), 0) == (ssize_t)sizeof(h) &&
+             memcmp(h.magic, TXN_SNAP_MAGIC, 8) == 0 && h.version == TXN_SNAP_VERSION &&
+             strncmp(h.kind, kind, sizeof(h.kind)) == 0;
+    close(fd);
+    return ok ? h.count : 0;
+}
+
+// 스냅샷을 매핑하고 내용 시작 주소를 돌려준다. 바꾼 내용은 이 프로세스에만 보인다.
+// 실패 시 NULL (errno: ENOENT, ESTALE, EBADMSG 또는 시스템 오류).
+static inline void *txn_snapshot_map(TxnSnapshot *s, const char *path, const TxnSnapSpec *spec) {
+    unsigned long long t0 = txn_now_ns();
+    memset(s, 0, sizeof(*s));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    struct stat st;
+    TxnSnapHeader h;
+    int err = 0;
+    if (fstat(fd, &st) < 0)
+        err = errno;
+    else if (pread(fd, &h, sizeof(h), 0) != (ssize_t)sizeof(h))
+        err = ESTALE;
+    else if (memcmp(h.magic, TXN_SNAP_MAGIC, 8) != 0 || h.version != TXN_SNAP_VERSION ||
+             h.header_bytes != TXN_SNAP_HEADER || strncmp(h.kind, spec->kind, sizeof(h.kind)) != 0 ||
+             h.count != spec->count || h.elem != spec->elem || h.param != spec->param ||
+             h.payload_bytes != spec->payload_bytes ||
+             (uint64_t)st.st_size != TXN_SNAP_HEADER + h.payload_bytes)
+        err = ESTALE;
+    if (err) {
+        close(fd);
+        errno = err;
+        return NULL;
+    }
+
+    size_t bytes = (size_t)st.st_size;
+    void *base = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+        return NULL;
+    void *payload = (char *)base + TXN_SNAP_HEADER;
+
+    // 검사합을 보며 모든 페이지를 한 번 읽으므로 순차 선읽기를 알린다
+    madvise(base, bytes, MADV_SEQUENTIAL);
+    if (txn_snapshot_sum(payload, h.payload_bytes) != h.checksum) {
+        munmap(base, bytes);
+        errno = EBADMSG;
+        return NULL;
+    }
+    madvise(base, bytes, MADV_NORMAL);
+
+    s->base = base;
+    s->bytes = bytes;
+    s->created = h.created;
+    s->load_sec = (txn_now_ns() - t0) / 1e9;
+    return payload;
+}
+
+static inline void txn_snapshot_unmap(TxnSnapshot *s) {
+    if (s->base)
+        munmap(s->base, s->bytes);
+    s->base = NULL;
+}
+
+// 임시 파일에 쓰고 rename 한다. 실패 시 -1 (errno 유지).
+static inline int txn_snapshot_save(const char *path, const TxnSnapSpec *spec, const void *payload) {
+    char tmp[4096 + 32];
+    snprintf(tmp, sizeof(tmp), "%s.%d", path, (int)getpid());
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return -1;
+
+    static char page[TXN_SNAP_HEADER];
+    TxnSnapHeader *h = (TxnSnapHeader *)page;
+    memset(page, 0, sizeof(page));
+    memcpy(h->magic, TXN_SNAP_MAGIC, 8);
+    h->version = TXN_SNAP_VERSION;
+    h->header_bytes = TXN_SNAP_HEADER;
+    snprintf(h->kind, sizeof(h->kind), "%s", spec->kind);
+    h->count = spec->count;
+    h->elem = spec->elem;
+    h->param = spec->param;
+    h->payload_bytes = spec->payload_bytes;
+    h->checksum = txn_snapshot_sum(payload, spec->payload_bytes);
+    h->created = (int64_t)time(NULL);
+
+    int ok = write(fd, page, sizeof(page)) == (ssize_t)sizeof(page);
+    const char *p = payload;
+    size_t left = spec->payload_bytes;
+    while (ok && left > 0) {
+        ssize_t w = write(fd, p, left);
+        if (w <= 0) {
+            ok = 0;
+            break;
+        }
+        p += w;
+        left -= (size_t)w;
+    }
+    int e = errno;
+    if (close(fd) != 0 && ok) {
+        ok = 0;
+        e = errno;
+    }
+    if (!ok || rename(tmp, path) != 0) {
+        e = ok ? errno : e;
+        unlink(tmp);
+        errno = e;
+        return -1;
+    }
+    return 0;
+}
+
+static inline void txn_snapshot_report(const TxnSnapshot *s, const char *path) {
+    printf("📸 스냅샷 %s: %.1f MB | 매핑+검사 %.6f 초\n", path,
+           (s->bytes - TXN_SNAP_HEADER) / (1024.0 * 1024.0), s->load_sec);
+}
+
+#endif
@@ -0,0 +1,150 @@
+// txn_sparse.h
+// 건드린 사용자만 실체화하는 희소 저장소 (개방 주소 해시 테이블)
+//
+// 사용자 500만 명을 미리 만들어 두어도 한 실행이 실제로 바꾸는 사용자는 몇천 명이다.
+// 여기서는 한 번도 바뀌지 않은 사용자를 "사용자 번호로부터 계산되는 기본값"으로 보고,
+// 처음 바꾸려 할 때 init 콜백으로 기본값을 채워 테이블에 넣는다.
+// 메모리와 초기화 시간은 전체 사용자 수가 아니라 건드린 사용자 수에 비례한다.
+//
+//   TxnSparse s;
+//   txn_sparse_init(&s, sizeof(int), account_default, NULL);
+//   int *bal = txn_sparse_touch(&s, user);      // 없으면 기본값으로 만든다
+//   const int *cur = txn_sparse_get(&s, user);  // 없으면 NULL (기본값 그대로)
+//   txn_sparse_release(&s);
+//
+// 키는 1 이상의 사용자 번호다 (0 은 빈 칸 표시). 선형 탐사, 적재율 1/2 에서 두 배로 키운다.
+
+#ifndef TXN_SPARSE_H
+#define TXN_SPARSE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#define TXN_SPARSE_MIN_CAP 1024
+
+typedef void (*TxnSparseInit)(int key, void *val, void *ctx);
+
+typedef struct {
+    int *keys;              // 0: 빈 칸
+    unsigned char *vals;    // cap * elem
+    size_t elem;
+    size_t cap, count;
+    size_t grows;           // 재배치 횟수
+    TxnSparseInit init;     // 기본값 채우기
+    void *ctx;
+} TxnSparse;
+
+// 32비트 정수 섞기. 탐사 시작 위치와, 사용자 번호에서 기본값을 뽑을 때 쓴다.
+static inline uint32_t txn_sparse_mix(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+static inline int txn_sparse_alloc(TxnSparse *s, size_t cap) {
+    s->keys = calloc(cap, sizeof(int));
+    s->vals = malloc(cap * s->elem);
+    if (!s->keys || !s->vals) {
+        free(s->keys);
+        free(s->vals);
+        s->keys = NULL;
+        s->vals = NULL;
+        errno = ENOMEM;
+        return -1;
+    }
+    s->cap = cap;
+    return 0;
+}
+
+// 실패 시 -1 (errno = ENOMEM).
+static inline int txn_sparse_init(TxnSparse *s, size_t elem, TxnSparseInit init, void *ctx) {
+    memset(s, 0, sizeof(*s));
+    s->elem = elem;
+    s->init = init;
+    s->ctx = ctx;
+    return txn_sparse_alloc(s, TXN_SPARSE_MIN_CAP);
+}
+
+static inline void txn_sparse_release(TxnSparse *s) {
+    free(s->keys);
+    free(s->vals);
+    s->keys = NULL;
+    s->vals = NULL;
+    s->cap = s->count = 0;
+}
+
+// key 의 칸 번호. 없으면 key 가 들어갈 빈 칸.
+static inline size_t txn_sparse_slot(const TxnSparse *s, int key) {
+    size_t mask = s->cap - 1;
+    size_t i = txn_sparse_mix((uint32_t)key) & mask;
+    while (s->keys[i] != 0 && s->keys[i] != key)
+        i = (i + 1) & mask;
+    return i;
+}
+
+static inline int txn_sparse_grow(TxnSparse *s) {
+    TxnSparse old = *s;
+    if (txn_sparse_alloc(s, old.cap * 2) < 0) {
+        *s = old;
+        return -1;
+    }
+    for (size_t i = 0; i < old.cap; i++) {
+        if (old.keys[i] == 0)
+            continue;
+        size_t j = txn_sparse_slot(s, old.keys[i]);
+        s->keys[j] = old.keys[i];
+        memcpy(s->vals + j * s->elem, old.vals + i * s->elem, s->elem);
+    }
+    free(old.keys);
+    free(old.vals);
+    s->grows++;
+    return 0;
+}
+
+// 실체화된 값. 없으면 NULL (호출자는 기본값으로 본다).
+static inline void *txn_sparse_get(const TxnSparse *s, int key) {
+    size_t i = txn_sparse_slot(s, key);
+    return s->keys[i] ? s->vals + i * s->elem : NULL;
+}
+
+// 값을 돌려주되 없으면 init 으로 기본값을 채워 만든다. 실패 시 NULL (errno = ENOMEM).
+// 반환한 포인터는 다음 touch 전까지만 유효하다 (테이블이 커지면 옮겨진다).
+static inline void *txn_sparse_touch(TxnSparse *s, int key) {
+    size_t i = txn_sparse_slot(s, key);
+    if (s->keys[i])
+        return s->vals + i * s->elem;
+    if ((s->count + 1) * 2 > s->cap) {
+        if (txn_sparse_grow(s) < 0)
+            return NULL;
+        i = txn_sparse_slot(s, key);
+    }
+    s->keys[i] = key;
+    s->count++;
+    void *v = s->vals + i * s->elem;
+    s->init(key, v, s->ctx);
+    return v;
+}
+
+// 실체화된 값을 칸 순서대로 돈다. key 와 val 이 선언된다.
+#define TXN_SPARSE_EACH(s, T, key, val)                                         \
+    for (size_t key##_i = 0; key##_i < (s)->cap; key##_i++)                     \
+        for (int key = (s)->keys[key##_i]; key; key = 0)                        \
+            for (T *val = (T *)(void *)((s)->vals + key##_i * (s)->elem); val; val = NULL)
+
+static inline size_t txn_sparse_bytes(const TxnSparse *s) {
+    return s->cap * (sizeof(int) + s->elem);
+}
+
+static inline void txn_sparse_report(const TxnSparse *s, const char *label, size_t population) {
+    printf("🧩 %s: 전체 %zu명 중 %zu명 실체화 | 테이블 %zu칸 (%.2f MB, 확장 %zu회)\n",
+           label, population, s->count, s->cap, txn_sparse_bytes(s) / (1024.0 * 1024.0),
+           s->grows);
+}
+
+#endif
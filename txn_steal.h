@@ -0,0 +1,322 @@
+// txn_steal.h
+// 사용자별 작업 묶음을 워커끼리 훔쳐 가며 처리하는 풀
+//
+// 예전 드라이버는 사용자 번호 % 워커 수로 작업을 미리 나눴다 (b_2: 짝/홀, c_2: % 3,
+// n_a_child: % 4). 거래가 많은 사용자가 몇 명 있거나 (대출은 sim_load 의 2배) 한쪽에
+// 몰리면 나머지 워커는 일찍 끝나고 논다. 여기서는
+//
+//   1. 레코드를 사용자 번호로 안정 정렬해 사용자별 묶음(그룹)을 만든다 (txn_groups_build).
+//      한 사용자의 거래는 한 묶음에 넣은 순서대로 들어가므로, 묶음 하나를 한 워커가
+//      처음부터 끝까지 처리하는 한 계좌별 처리 순서는 예전과 같다.
+//   2. 묶음 번호를 워커 수만큼 연속 구간으로 나눠 워커별 덱에 둔다.
+//      워커는 자기 덱의 앞에서 하나씩 꺼내고, 비면 무작위로 고른 다른 워커의 덱 뒤쪽에서
+//      남은 묶음의 절반을 가져와 자기 덱으로 삼는다. 훔치는 단위가 묶음이라 한 사용자의
+//      거래가 두 워커로 갈라지지 않는다.
+//
+// 덱은 묶음 번호의 연속 구간 [top, bottom) 뿐이라 64비트 하나에 담고, 주인은 top 을,
+// 도둑은 bottom 을 CAS 로 옮긴다. 덱의 내용이 이 값 하나로 다 표현되므로 같은 값이 다시
+// 나타나도 (ABA) CAS 는 그 순간의 내용을 바르게 나눈다. 잠금도, 원소 배열도 없다.
+// 모든 덱이 빈 것을 본 워커는 끝낸다 (막 훔쳐 간 묶음은 훔친 워커가 처리한다).
+//
+//   unsigned workers = txn_workers_arg(&argc, argv, DEFAULT_WORKERS);  // txn_workers.h
+//   TxnGroups g;
+//   const TxnRecord *spans[3] = {atm, loan, transfer};  // 묶음 안에서 이 순서로 놓인다
+//   size_t counts[3] = {n_atm, n_loan, n_transfer};
+//   txn_groups_build(&g, spans, counts, 3);
+//   TxnSteal pool;
+//   txn_steal_run(&pool, &g, workers, run_group, ctx);  // 호출한 스레드가 워커 0
+//   txn_steal_report(&pool);
+//   txn_steal_free(&pool);
+//   txn_groups_free(&g);
+//
+// 서로 다른 묶음은 동시에 돌 수 있으므로, 송금 수신자처럼 다른 사용자의 상태를 고치는
+// 처리기는 예전처럼 잠금이나 원자 연산으로 보호해야 한다 (txn_locks.h, txn_atomic.h).
+
+#ifndef TXN_STEAL_H
+#define TXN_STEAL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "txn_reader.h"
+#include "txn_workers.h"
+
+#define TXN_STEAL_LINE    64
+#define TXN_GROUP_RADIX   16     // 정렬 한 번에 보는 사용자 번호 비트 수
+
+// ---------- 사용자별 묶음 ----------
+
+typedef struct {
+    TxnRecord *recs;    // 사용자 번호 순. 한 사용자 안에서는 spans 순서, 그 안에서는 원래 순서
+    size_t *start;      // 묶음 g 는 recs[start[g] .. start[g + 1])
+    size_t groups;
+    size_t total;
+} TxnGroups;
+
+static inline uint32_t txn_group_key(const TxnRecord *r) {
+    return (uint32_t)r->user;   // 잘못된(음수) 번호도 자기 묶음에 모여 처리기가 거절한다
+}
+
+// 사용자 번호의 shift 부터 TXN_GROUP_RADIX 비트로 src → dst 안정 계수 정렬
+static inline void txn_groups_pass(TxnRecord *dst, const TxnRecord *const src[],
+                                   const size_t counts[], int nspans, unsigned shift,
+                                   size_t *count) {
+    const size_t buckets = (size_t)1 << TXN_GROUP_RADIX, mask = buckets - 1;
+    memset(count, 0, buckets * sizeof(size_t));
+    for (int s = 0; s < nspans; s++)
+        for (size_t i = 0; i < counts[s]; i++)
+            count[(txn_group_key(&src[s][i]) >> shift) & mask]++;
+    size_t pos = 0;
+    for (size_t b = 0; b < buckets; b++) {
+        size_t c = count[b];
+        count[b] = pos;
+        pos += c;
+    }
+    for (int s = 0; s < nspans; s++)
+        for (size_t i = 0; i < counts[s]; i++)
+            dst[count[(txn_group_key(&src[s][i]) >> shift) & mask]++] = src[s][i];
+}
+
+// spans[0..nspans) 의 레코드를 복사해 사용자별로 묶는다. 원본은 곧바로 풀어도 된다.
+// 사용자 번호가 16비트 안이면 한 번, 아니면 두 번 정렬한다 (LSD, 안정).
+// 실패 시 -1 (errno 설정).
+static inline int txn_groups_build(TxnGroups *g, const TxnRecord *const spans[],
+                                   const size_t counts[], int nspans) {
+    memset(g, 0, sizeof(*g));
+    uint32_t max_key = 0;
+    for (int s = 0; s < nspans; s++) {
+        g->total += counts[s];
+        for (size_t i = 0; i < counts[s]; i++)
+            if (txn_group_key(&spans[s][i]) > max_key)
+                max_key = txn_group_key(&spans[s][i]);
+    }
+    size_t n = g->total;
+    size_t *count = malloc(((size_t)1 << TXN_GROUP_RADIX) * sizeof(size_t));
+    g->recs = malloc((n ? n : 1) * sizeof(TxnRecord));
+    g->start = malloc((n + 1) * sizeof(size_t));
+    TxnRecord *tmp = NULL;
+    int two_pass = max_key >> TXN_GROUP_RADIX;
+    if (two_pass)
+        tmp = malloc((n ? n : 1) * sizeof(TxnRecord));
+    if (!count || !g->recs || !g->start || (two_pass && !tmp)) {
+        free(count);
+        free(tmp);
+        free(g->recs);
+        free(g->start);
+        memset(g, 0, sizeof(*g));
+        errno = ENOMEM;
+        return -1;
+    }
+
+    if (two_pass) {
+        const TxnRecord *const mid[1] = {tmp};
+        txn_groups_pass(tmp, spans, counts, nspans, 0, count);
+        txn_groups_pass(g->recs, mid, &n, 1, TXN_GROUP_RADIX, count);
+        free(tmp);
+    } else {
+        txn_groups_pass(g->recs, spans, counts, nspans, 0, count);
+    }
+    free(count);
+
+    for (size_t i = 0; i < n; i++)
+        if (i == 0 || g->recs[i].user != g->recs[i - 1].user)
+            g->start[g->groups++] = i;
+    g->start[g->groups] = n;
+    return 0;
+}
+
+static inline void txn_groups_free(TxnGroups *g) {
+    free(g->recs);
+    free(g->start);
+    memset(g, 0, sizeof(*g));
+}
+
+// ---------- 워커별 덱 ----------
+
+typedef void (*TxnGroupFn)(const TxnRecord *recs, size_t n, void *ctx);
+
+// 덱마다 캐시 라인 하나. 통계는 주인만 고친다.
+typedef struct {
+    _Alignas(TXN_STEAL_LINE) _Atomic uint64_t span;   // 위 32비트 top, 아래 32비트 bottom
+    unsigned long long groups, tasks;   // 처리한 묶음, 거래
+    unsigned long long steals, stolen;  // 훔친 횟수, 훔쳐 온 묶음
+    uint64_t seed;
+} TxnStealDeque;
+
+typedef struct TxnSteal TxnSteal;
+
+typedef struct {
+    TxnSteal *pool;
+    unsigned id;
+} TxnStealArg;
+
+struct TxnSteal {
+    const TxnGroups *g;
+    TxnGroupFn fn;
+    void *ctx;
+    unsigned workers;
+    TxnStealDeque *dq;
+    double sec;
+};
+
+static inline uint64_t txn_steal_pack(uint32_t top, uint32_t bottom) {
+    return (uint64_t)top << 32 | bottom;
+}
+
+// 주인: 앞에서 묶음 하나. 비었으면 0.
+static inline int txn_steal_pop(TxnStealDeque *d, size_t *group) {
+    uint64_t cur = atomic_load_explicit(&d->span, memory_order_acquire);
+    for (;;) {
+        uint32_t top = (uint32_t)(cur >> 32), bottom = (uint32_t)cur;
+        if (top >= bottom)
+            return 0;
+        if (atomic_compare_exchange_weak_explicit(&d->span, &cur, txn_steal_pack(top + 1, bottom),
+                                                  memory_order_acq_rel, memory_order_acquire)) {
+            *group = top;
+            return 1;
+        }
+    }
+}
+
+// 도둑: 남은 묶음의 뒤쪽 절반 (하나 남았으면 그 하나) 을 [*begin, *end) 로 가져온다
+static inline int txn_steal_take(TxnStealDeque *d, uint32_t *begin, uint32_t *end) {
+    uint64_t cur = atomic_load_explicit(&d->span, memory_order_acquire);
+    for (;;) {
+        uint32_t top = (uint32_t)(cur >> 32), bottom = (uint32_t)cur;
+        if (top >= bottom)
+            return 0;
+        uint32_t k = (bottom - top + 1) / 2;
+        if (atomic_compare_exchange_weak_explicit(&d->span, &cur, txn_steal_pack(top, bottom - k),
+                                                  memory_order_acq_rel, memory_order_acquire)) {
+            *begin = bottom - k;
+            *end = bottom;
+            return 1;
+        }
+    }
+}
+
+static inline uint64_t txn_steal_rand(uint64_t *s) {
+    uint64_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *s = x;
+}
+
+// 자기 덱이 빈 워커가 부른다. 무작위 상대를 몇 번 고르고, 그래도 없으면 모두 훑는다.
+// 훔친 구간은 자기 덱에 두어 다른 워커가 다시 나눠 갈 수 있게 한다. 모두 비었으면 0.
+static inline int txn_steal_refill(TxnSteal *p, unsigned self) {
+    TxnStealDeque *me = &p->dq[self];
+    unsigned n = p->workers;
+    uint32_t begin, end;
+    for (unsigned i = 0; i < 3 * n; i++) {
+        unsigned v;
+        if (i < 2 * n)
+            v = (unsigned)(txn_steal_rand(&me->seed) % n);
+        else
+            v = (self + 1 + (i - 2 * n)) % n;
+        if (v == self || !txn_steal_take(&p->dq[v], &begin, &end))
+            continue;
+        me->steals++;
+        me->stolen += end - begin;
+        atomic_store_explicit(&me->span, txn_steal_pack(begin, end), memory_order_release);
+        return 1;
+    }
+    return 0;
+}
+
+static inline void txn_steal_work(TxnSteal *p, unsigned self) {
+    TxnStealDeque *me = &p->dq[self];
+    const TxnGroups *g = p->g;
+    size_t group;
+    do {
+        while (txn_steal_pop(me, &group)) {
+            size_t b = g->start[group], e = g->start[group + 1];
+            p->fn(&g->recs[b], e - b, p->ctx);
+            me->groups++;
+            me->tasks += e - b;
+        }
+    } while (txn_steal_refill(p, self));
+}
+
+static inline void *txn_steal_thread(void *arg) {
+    TxnStealArg *a = arg;
+    txn_steal_work(a->pool, a->id);
+    return NULL;
+}
+
+// 묶음 g 를 workers 개 워커로 처리하고 모두 끝나면 돌아온다. 호출한 스레드도 워커 0 으로
+// 일한다. 실패 시 -1 (errno 설정, 이미 띄운 워커는 끝까지 처리하고 돌아온다).
+static inline int txn_steal_run(TxnSteal *p, const TxnGroups *g, unsigned workers,
+                                TxnGroupFn fn, void *ctx) {
+    memset(p, 0, sizeof(*p));
+    if (workers < 1 || workers > TXN_WORKERS_MAX || g->groups > UINT32_MAX) {
+        errno = EINVAL;
+        return -1;
+    }
+    p->g = g;
+    p->fn = fn;
+    p->ctx = ctx;
+    p->workers = workers;
+    p->dq = aligned_alloc(TXN_STEAL_LINE, workers * sizeof(TxnStealDeque));
+    if (!p->dq) {
+        errno = ENOMEM;
+        return -1;
+    }
+    for (unsigned w = 0; w < workers; w++) {
+        TxnStealDeque *d = &p->dq[w];
+        memset(d, 0, sizeof(*d));
+        atomic_init(&d->span, txn_steal_pack((uint32_t)(g->groups * w / workers),
+                                             (uint32_t)(g->groups * (w + 1) / workers)));
+        d->seed = 0x9e3779b97f4a7c15ULL ^ ((uint64_t)(w + 1) << 32);
+    }
+
+    unsigned long long t0 = txn_now_ns();
+    pthread_t tids[TXN_WORKERS_MAX];
+    TxnStealArg args[TXN_WORKERS_MAX];
+    unsigned started = 1;
+    int rc = 0;
+    for (unsigned w = 1; w < workers; w++, started++) {
+        args[w] = (TxnStealArg){p, w};
+        if ((rc = pthread_create(&tids[w], NULL, txn_steal_thread, &args[w])) != 0)
+            break;
+    }
+    // 못 띄운 워커의 덱은 남은 워커가 훔쳐 간다
+    txn_steal_work(p, 0);
+    for (unsigned w = 1; w < started; w++)
+        pthread_join(tids[w], NULL);
+    p->sec = (txn_now_ns() - t0) / 1e9;
+    if (rc != 0) {
+        errno = rc;
+        return -1;
+    }
+    return 0;
+}
+
+static inline void txn_steal_report(const TxnSteal *p) {
+    unsigned long long steals = 0, stolen = 0, max_tasks = 0;
+    for (unsigned w = 0; w < p->workers; w++) {
+        steals += p->dq[w].steals;
+        stolen += p->dq[w].stolen;
+        if (p->dq[w].tasks > max_tasks)
+            max_tasks = p->dq[w].tasks;
+    }
+    printf("🔀 작업 훔치기: 워커 %u개 | 사용자 묶음 %zu개 (거래 %zu건) | 훔치기 %llu회, 묶음 %llu개"
+           " | %.6f 초\n", p->workers, p->g->groups, p->g->total, steals, stolen, p->sec);
+    printf("   워커별 거래:");
+    for (unsigned w = 0; w < p->workers; w++)
+        printf(" %llu", p->dq[w].tasks);
+    double avg = p->workers ? (double)p->g->total / p->workers : 0.0;
+    printf(" (최대/평균 %.2f)\n", avg > 0 ? max_tasks / avg : 0.0);
+}
+
+static inline void txn_steal_free(TxnSteal *p) {
+    free(p->dq);
+    p->dq = NULL;
+}
+
+#endif
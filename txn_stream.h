@@ -0,0 +1,145 @@
+// txn_stream.h
+// 파싱과 실행을 겹치는 스트리밍 입력 (생산자 스레드 + 워커별 유한 큐)
+//
+// 생산자 스레드가 입력을 읽으며 레코드를 맡을 워커 (txn_record_owner) 의 큐에 넣고,
+// 워커는 전체 파싱이 끝나기를 기다리지 않고 바로 처리를 시작한다.
+// 큐가 가득 차면 생산자가 멈춘다 (back-pressure).
+//
+// 큐는 MAP_SHARED 익명 매핑 + PTHREAD_PROCESS_SHARED 동기화 객체로 만들므로
+// 스레드 워커뿐 아니라 fork 된 자식 프로세스 워커도 같은 큐를 쓸 수 있다.
+// 생산자 스레드는 fork 이후에 띄워야 한다.
+//
+// 입력 창(txn_reader)과 워커 큐가 모두 고정 크기라 stdin 으로 끝없이 들어오는
+// 입력도 일정한 메모리로 처리한다. 부모가 넘긴 TxnQueues 가 있으면 파일 대신
+// 그 배열을 순서대로 흘려보낼 수 있다 (TxnProducer.it).
+
+#ifndef TXN_STREAM_H
+#define TXN_STREAM_H
+
+#include <pthread.h>
+#include <sys/mman.h>
+#include "txn_queues.h"
+
+#define TXN_STREAM_CAP   4096  // 워커당 큐 길이 (레코드 수)
+#define TXN_STREAM_BATCH 64    // 워커가 한 번에 꺼내는 최대 건수
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    size_t head, tail, count;
+    int closed;
+    unsigned long long pushed;
+    unsigned long long first_ns;  // 이 워커가 첫 레코드를 꺼낸 시각 (0: 아직 없음)
+    TxnRecord buf[TXN_STREAM_CAP];
+} TxnStream;
+
+typedef struct {
+    TxnReader *rd;     // 호출자가 열어 둔 리더
+    TxnStream *queues;
+    int n;
+    TxnQueueIter *it;  // NULL 이 아니면 rd 대신 이것을 읽는다
+    unsigned mask;     // (1 << type) 의 OR, 0 이면 모든 type
+} TxnProducer;
+
+static inline TxnStream *txn_stream_create(int n) {
+    size_t bytes = sizeof(TxnStream) * (size_t)n;
+    TxnStream *qs = mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (qs == MAP_FAILED)
+        return NULL;
+
+    pthread_mutexattr_t ma;
+    pthread_condattr_t ca;
+    pthread_mutexattr_init(&ma);
+    pthread_mutexattr_setpshared(&ma, PTHREAD_PROCESS_SHARED);
+    pthread_condattr_init(&ca);
+    pthread_condattr_setpshared(&ca, PTHREAD_PROCESS_SHARED);
+    for (int i = 0; i < n; i++) {
+        pthread_mutex_init(&qs[i].lock, &ma);
+        pthread_cond_init(&qs[i].not_empty, &ca);
+        pthread_cond_init(&qs[i].not_full, &ca);
+    }
+    pthread_mutexattr_destroy(&ma);
+    pthread_condattr_destroy(&ca);
+    return qs;
+}
+
+static inline void txn_stream_destroy(TxnStream *qs, int n) {
+    for (int i = 0; i < n; i++) {
+        pthread_mutex_destroy(&qs[i].lock);
+        pthread_cond_destroy(&qs[i].not_empty);
+        pthread_cond_destroy(&qs[i].not_full);
+    }
+    munmap(qs, sizeof(TxnStream) * (size_t)n);
+}
+
+// 큐에 자리가 날 때까지 기다렸다가 넣는다.
+static inline void txn_stream_push(TxnStream *q, const TxnRecord *rec) {
+    pthread_mutex_lock(&q->lock);
+    while (q->count == TXN_STREAM_CAP)
+        pthread_cond_wait(&q->not_full, &q->lock);
+    q->buf[q->tail] = *rec;
+    q->tail = (q->tail + 1) % TXN_STREAM_CAP;
+    q->count++;
+    q->pushed++;
+    pthread_cond_signal(&q->not_empty);
+    pthread_mutex_unlock(&q->lock);
+}
+
+static inline void txn_stream_close(TxnStream *q) {
+    pthread_mutex_lock(&q->lock);
+    q->closed = 1;
+    pthread_cond_broadcast(&q->not_empty);
+    pthread_mutex_unlock(&q->lock);
+}
+
+// 최대 max 건을 꺼낸다. 0 이면 큐가 닫히고 비었다는 뜻.
+static inline size_t txn_stream_pop(TxnStream *q, TxnRecord *out, size_t max) {
+    pthread_mutex_lock(&q->lock);
+    while (q->count == 0 && !q->closed)
+        pthread_cond_wait(&q->not_empty, &q->lock);
+
+    size_t n = 0;
+    while (n < max && q->count > 0) {
+        out[n++] = q->buf[q->head];
+        q->head = (q->head + 1) % TXN_STREAM_CAP;
+        q->count--;
+    }
+    if (n > 0 && q->first_ns == 0)
+        q->first_ns = txn_now_ns();
+    pthread_cond_signal(&q->not_full);
+    pthread_mutex_unlock(&q->lock);
+    return n;
+}
+
+// 생산자 스레드: 입력 끝까지 읽어 워커 큐에 나눠 넣고 모든 큐를 닫는다.
+static inline void *txn_stream_producer(void *arg) {
+    TxnProducer *p = arg;
+    TxnRecord rec;
+    while (p->it ? txn_queue_iter_next(p->it, &rec) : txn_reader_next(p->rd, &rec)) {
+        if (p->mask && !(p->mask & (1u << rec.type)))
+            continue;
+        txn_stream_push(&p->queues[txn_record_owner(&rec, (unsigned)p->n)], &rec);
+    }
+    for (int i = 0; i < p->n; i++)
+        txn_stream_close(&p->queues[i]);
+    return NULL;
+}
+
+// 시작 시각(start_ns, txn_now_ns 기준)부터 첫 거래 처리까지 걸린 시간을 출력한다.
+static inline void txn_stream_report(const TxnStream *qs, int n, unsigned long long start_ns) {
+    unsigned long long first = 0;
+    for (int i = 0; i < n; i++) {
+        if (qs[i].first_ns && (first == 0 || qs[i].first_ns < first))
+            first = qs[i].first_ns;
+    }
+    printf("🚰 스트리밍: 워커 %d개", n);
+    for (int i = 0; i < n; i++)
+        printf(" | #%d %llu건", i, qs[i].pushed);
+    printf("\n");
+    if (first)
+        printf("  ⏱ 첫 거래까지: %.6f 초\n", (first - start_ns) / 1e9);
+}
+
+#endif
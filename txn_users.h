@@ -0,0 +1,71 @@
+// txn_users.h
+// 사용자 수를 컴파일 시점 MAX_USERS 대신 실행 시점에 정한다
+//
+// 각 드라이버는 예전 MAX_USERS 값을 DEFAULT_USERS 로 두고, 실행할 때
+// 환경변수 TXN_USERS 가 있으면 그 값을 쓴다. 정한 값은 다시 TXN_USERS 에 써 두므로
+// exec 된 자식(대출 처리)도 부모와 같은 사용자 수를 쓴다.
+//
+//   max_users = txn_users_count(DEFAULT_USERS);
+//   acc_db.accounts = txn_users_table(sizeof(AccountInfo), max_users);
+//   txn_users_report("계좌 테이블", max_users, sizeof(AccountInfo));
+//   if (!txn_user_valid(user, max_users)) { ... }
+//
+// 크기 계산은 모두 size_t(64비트)로 한다. 사용자 번호 자체는 거래 레코드의 int32 라서
+// 최대 INT32_MAX (약 21억) 명까지다.
+
+#ifndef TXN_USERS_H
+#define TXN_USERS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+
+#define TXN_USERS_ENV "TXN_USERS"
+#define TXN_USERS_MAX ((size_t)INT32_MAX)
+
+// TXN_USERS 가 올바르면 그 값, 아니면 fallback. 결과를 TXN_USERS 에 내보낸다.
+static inline size_t txn_users_count(size_t fallback) {
+    size_t n = fallback;
+    const char *e = getenv(TXN_USERS_ENV);
+    if (e && *e) {
+        char *end;
+        errno = 0;
+        unsigned long long v = strtoull(e, &end, 10);
+        if (errno || *end || v < 1 || v > TXN_USERS_MAX)
+            fprintf(stderr, "%s=%s 무시: 1 ~ %zu 사이여야 한다 (기본 %zu명 사용)\n",
+                    TXN_USERS_ENV, e, TXN_USERS_MAX, fallback);
+        else
+            n = (size_t)v;
+    }
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%zu", n);
+    setenv(TXN_USERS_ENV, buf, 1);
+    return n;
+}
+
+static inline int txn_user_valid(int user, size_t n) {
+    return user >= 1 && (size_t)user <= n;
+}
+
+// 사용자 번호 1..n 을 바로 쓰도록 n + 1 칸을 0 으로 잡는다. 실패 시 NULL (errno = ENOMEM).
+static inline void *txn_users_table(size_t elem, size_t n) {
+    if (n >= SIZE_MAX / elem) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    return calloc(n + 1, elem);
+}
+
+static inline size_t txn_users_bytes(size_t elem, size_t n) {
+    return (n + 1) * elem;
+}
+
+// 대개 fork 전에 불리므로 바로 내보낸다 (버퍼에 남으면 자식이 한 번 더 찍는다).
+static inline void txn_users_report(const char *label, size_t n, size_t elem) {
+    printf("📐 %s: %zu명 × %zu B = %.2f MB\n", label, n, elem,
+           txn_users_bytes(elem, n) / (1024.0 * 1024.0));
+    fflush(stdout);
+}
+
+#endif
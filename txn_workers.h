@@ -0,0 +1,93 @@
+// txn_workers.h
+// 워커 수를 실행 시점에 정한다 (--workers N, TXN_WORKERS)
+//
+// 각 드라이버는 예전 NUM_WORKERS / THREAD_COUNT 값을 DEFAULT_WORKERS 로 두고
+//
+//   num_workers = txn_workers_arg(&argc, argv, DEFAULT_WORKERS);  // 잘못된 값이면 0
+//
+// 로 정한다. 순서는 --workers N > TXN_WORKERS > DEFAULT_WORKERS.
+// --workers N 을 받았을 때만 TXN_WORKERS 에 써서 exec 된 자식에게 넘긴다. 받지 않았으면
+// 자식(m_c, multichild, n_a_child)은 부모의 기본값이 아니라 자기 DEFAULT_WORKERS 를 쓴다.
+// 워커가 없고 exec 하는 자식에게 넘겨주기만 하는 실행기는 txn_workers_opt 만 부른다.
+
+#ifndef TXN_WORKERS_H
+#define TXN_WORKERS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#define TXN_WORKERS_ENV "TXN_WORKERS"
+#define TXN_WORKERS_OPT "--workers"
+#define TXN_WORKERS_MAX 64     // 워커 수 상한 (워커별 배열 크기)
+
+// TXN_WORKERS 가 올바르면 그 값, 아니면 fallback. 환경변수는 건드리지 않으므로 exec 된
+// 자식은 --workers 나 TXN_WORKERS 가 주어졌을 때만 부모와 같은 값을 쓰고, 아니면 자기 기본값을 쓴다.
+static inline unsigned txn_workers_count(unsigned fallback) {
+    unsigned n = fallback;
+    const char *e = getenv(TXN_WORKERS_ENV);
+    if (e && *e) {
+        char *end;
+        errno = 0;
+        unsigned long v = strtoul(e, &end, 10);
+        if (errno || *end || v < 1 || v > TXN_WORKERS_MAX)
+            fprintf(stderr, "%s=%s 무시: 1 ~ %d 사이여야 한다 (기본 %u개 사용)\n",
+                    TXN_WORKERS_ENV, e, TXN_WORKERS_MAX, fallback);
+        else
+            n = (unsigned)v;
+    }
+    return n;
+}
+
+// argv 에서 "--workers N" 또는 "--workers=N" 을 찾아 빼고 (*argc 도 줄인다) TXN_WORKERS 에
+// 내보낸다. 옵션이 있으면 그 값, 없으면 0, 값이 잘못됐으면 -1.
+static inline int txn_workers_opt(int *argc, char **argv) {
+    int out = 1;
+    const char *val = NULL;
+    int bad = 0;
+    size_t len = strlen(TXN_WORKERS_OPT);
+    for (int i = 1; i < *argc; i++) {
+        if (strcmp(argv[i], TXN_WORKERS_OPT) == 0) {
+            if (i + 1 < *argc)
+                val = argv[++i];
+            else
+                bad = 1;
+        } else if (strncmp(argv[i], TXN_WORKERS_OPT "=", len + 1) == 0) {
+            val = argv[i] + len + 1;
+        } else {
+            argv[out++] = argv[i];
+        }
+    }
+    *argc = out;
+    argv[out] = NULL;
+
+    unsigned long v = 0;
+    if (val) {
+        char *end;
+        errno = 0;
+        v = strtoul(val, &end, 10);
+        if (errno || !*val || *end || v < 1 || v > TXN_WORKERS_MAX)
+            bad = 1;
+    }
+    if (bad) {
+        fprintf(stderr, "%s 값이 잘못됐다: 1 ~ %d 사이여야 한다\n", TXN_WORKERS_OPT,
+                TXN_WORKERS_MAX);
+        return -1;
+    }
+    if (val) {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%lu", v);
+        setenv(TXN_WORKERS_ENV, buf, 1);   // 옵션이 환경변수보다 먼저다
+    }
+    return (int)v;
+}
+
+// 워커 수: --workers N > TXN_WORKERS > fallback. 옵션 값이 잘못됐으면 0.
+static inline unsigned txn_workers_arg(int *argc, char **argv, unsigned fallback) {
+    if (txn_workers_opt(argc, argv) < 0)
+        return 0;
+    return txn_workers_count(fallback);
+}
+
+#endif